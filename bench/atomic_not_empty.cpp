@@ -0,0 +1,86 @@
+/*
+atomic_not_empty.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/atomic_not_empty.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+namespace {
+
+  struct config {
+    long timeout = 30;
+    long retries = 3;
+  };
+
+  // Readers only: every benchmark thread reads the shared configuration in a loop.
+
+  milli::atomic_not_empty<config> rcu_config(std::unique_ptr<config>(new config));
+
+  void atomic_not_empty_read(benchmark::State& state){
+    for(auto _ : state){
+      auto guard = rcu_config.read();
+      benchmark::DoNotOptimize(guard->timeout + guard->retries);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+#ifdef __cpp_lib_atomic_shared_ptr
+  std::atomic<std::shared_ptr<const config>> shared_config(std::make_shared<const config>());
+
+  auto load_shared_config() -> std::shared_ptr<const config>{
+    return shared_config.load();
+  }
+#else
+  std::shared_ptr<const config> shared_config = std::make_shared<const config>();
+
+  auto load_shared_config() -> std::shared_ptr<const config>{
+    return std::atomic_load(&shared_config);
+  }
+#endif
+
+  void atomic_shared_ptr_read(benchmark::State& state){
+    for(auto _ : state){
+      auto current = load_shared_config();
+      benchmark::DoNotOptimize(current->timeout + current->retries);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  std::shared_mutex config_mutex;
+  config locked_config;
+
+  void shared_mutex_read(benchmark::State& state){
+    for(auto _ : state){
+      std::shared_lock<std::shared_mutex> lock(config_mutex);
+      benchmark::DoNotOptimize(locked_config.timeout + locked_config.retries);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  const int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+}
+
+BENCHMARK(atomic_not_empty_read)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK(atomic_shared_ptr_read)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK(shared_mutex_read)->ThreadRange(1, max_threads)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,140 @@
+/*
+cow.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/cow.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t payload_size = 4096;
+  constexpr std::size_t operations = 1024;
+
+  using payload = std::vector<int>;
+
+  struct deep_copy {
+    using type = payload;
+
+    static auto make() -> type{
+      return payload(payload_size, 1);
+    }
+
+    static auto read(const type& value, std::size_t index) -> int{
+      return value[index];
+    }
+
+    static auto write(type& value, std::size_t index) -> void{
+      ++value[index];
+    }
+  };
+
+  // The hand-rolled alternative: immutable shared payloads, every write makes a new one.
+  struct shared_ptr_copy {
+    using type = std::shared_ptr<const payload>;
+
+    static auto make() -> type{
+      return std::make_shared<const payload>(payload_size, 1);
+    }
+
+    static auto read(const type& value, std::size_t index) -> int{
+      return (*value)[index];
+    }
+
+    static auto write(type& value, std::size_t index) -> void{
+      auto clone = std::make_shared<payload>(*value);
+      ++(*clone)[index];
+      value = std::move(clone);
+    }
+  };
+
+  struct cow_copy {
+    using type = milli::cow<payload>;
+
+    static auto make() -> type{
+      return milli::make_cow<payload>(payload_size, 1);
+    }
+
+    static auto read(const type& value, std::size_t index) -> int{
+      return (*value)[index];
+    }
+
+    static auto write(type& value, std::size_t index) -> void{
+      ++value.write()[index];
+    }
+  };
+
+  // state.range(0) is the percentage of operations that write.
+  auto make_writes(benchmark::State& state) -> std::vector<bool>{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    std::vector<bool> writes(operations);
+    for(std::size_t index = 0; index != operations; ++index)
+      writes[index] = percent(generator) < state.range(0);
+    return writes;
+  }
+
+  template <typename Strategy>
+  auto handle(typename Strategy::type value, bool write, std::size_t index) -> int{
+    if(write)
+      Strategy::write(value, index);
+    return Strategy::read(value, index);
+  }
+
+  // The payload is passed by value to a handler that reads it and sometimes modifies its own copy.
+  template <typename Strategy>
+  void pass_by_value(benchmark::State& state){
+    const auto document = Strategy::make();
+    const auto writes = make_writes(state);
+    for(auto _ : state){
+      long sum = 0;
+      for(std::size_t index = 0; index != operations; ++index)
+        sum += handle<Strategy>(document, writes[index], index);
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * operations);
+  }
+
+  // The owner keeps modifying its payload and publishes a snapshot on the operations that do not write.
+  template <typename Strategy>
+  void update_owned(benchmark::State& state){
+    auto document = Strategy::make();
+    auto snapshot = document;
+    const auto writes = make_writes(state);
+    for(auto _ : state){
+      for(std::size_t index = 0; index != operations; ++index){
+        if(writes[index])
+          Strategy::write(document, index);
+        else
+          snapshot = document;
+      }
+      benchmark::DoNotOptimize(Strategy::read(snapshot, 0));
+    }
+    state.SetItemsProcessed(state.iterations() * operations);
+  }
+
+}
+
+BENCHMARK_TEMPLATE(pass_by_value, deep_copy)->Arg(0)->Arg(10)->Arg(50);
+BENCHMARK_TEMPLATE(pass_by_value, shared_ptr_copy)->Arg(0)->Arg(10)->Arg(50);
+BENCHMARK_TEMPLATE(pass_by_value, cow_copy)->Arg(0)->Arg(10)->Arg(50);
+BENCHMARK_TEMPLATE(update_owned, deep_copy)->Arg(50)->Arg(90)->Arg(99);
+BENCHMARK_TEMPLATE(update_owned, shared_ptr_copy)->Arg(50)->Arg(90)->Arg(99);
+BENCHMARK_TEMPLATE(update_owned, cow_copy)->Arg(50)->Arg(90)->Arg(99);
+
+BENCHMARK_MAIN();
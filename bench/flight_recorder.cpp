@@ -0,0 +1,90 @@
+/*
+flight_recorder.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/flight_recorder.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace {
+
+  constexpr std::size_t events_per_iteration = 1024;
+
+  void trace_without_arguments(benchmark::State& state){
+    for(auto _ : state){
+      for(std::size_t i = 0; i < events_per_iteration; ++i)
+        MILLI_TRACE("event");
+      benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * events_per_iteration);
+  }
+
+  void trace_three_arguments(benchmark::State& state){
+    for(auto _ : state){
+      for(std::size_t i = 0; i < events_per_iteration; ++i)
+        MILLI_TRACE("event", i, state.thread_index(), -1);
+      benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * events_per_iteration);
+  }
+
+  // The obvious alternatives: one ring shared by all threads, guarded by a mutex or claimed slot by slot with
+  // fetch_add. Both make every event a write to a cache line that all recording threads write to.
+  milli::flight_event shared_events[milli::flight_recorder::events_per_thread];
+  std::mutex shared_mutex;
+  std::uint64_t shared_written = 0;
+  std::atomic<std::uint64_t> shared_claimed{0};
+
+  auto fill(milli::flight_event& event, std::uint64_t argument) -> void {
+    event.timestamp = milli::detail::read_ticks();
+    event.arguments[0] = argument;
+    event.arguments[1] = 0;
+    event.arguments[2] = 0;
+    event.argument_count = 1;
+    event.name[0] = '\0';
+  }
+
+  void shared_ring_with_mutex(benchmark::State& state){
+    for(auto _ : state){
+      for(std::size_t i = 0; i < events_per_iteration; ++i){
+        std::lock_guard<std::mutex> lock(shared_mutex);
+        fill(shared_events[shared_written++ % milli::flight_recorder::events_per_thread], i);
+      }
+      benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * events_per_iteration);
+  }
+
+  void shared_ring_with_fetch_add(benchmark::State& state){
+    for(auto _ : state){
+      for(std::size_t i = 0; i < events_per_iteration; ++i){
+        auto index = shared_claimed.fetch_add(1, std::memory_order_relaxed);
+        fill(shared_events[index % milli::flight_recorder::events_per_thread], i);
+      }
+      benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * events_per_iteration);
+  }
+
+}
+
+BENCHMARK(trace_without_arguments)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(trace_three_arguments)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(shared_ring_with_mutex)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(shared_ring_with_fetch_add)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
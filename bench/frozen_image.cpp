@@ -0,0 +1,160 @@
+/*
+frozen_image.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <benchmark/benchmark.h>
+#include <milli/frozen_image.hpp>
+#include <milli/make_container_from.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  struct quote {
+    std::uint32_t bid;
+    std::uint32_t ask;
+  };
+
+  using entry = std::pair<std::uint64_t, quote>;
+  using frozen_quotes = milli::frozen_map<std::uint64_t, quote>;
+
+  auto make_entry(std::size_t index) -> entry {
+    std::uint64_t key = (index + 1) * 0x9e3779b97f4a7c15ull;
+    return entry(key, quote{static_cast<std::uint32_t>(key >> 32), static_cast<std::uint32_t>(key)});
+  }
+
+  auto entry_less(const entry& lhs, const entry& rhs) -> bool {
+    return lhs.first < rhs.first;
+  }
+
+  // What every process does without an image: generate the table and sort it into a flat map.
+  auto build(std::size_t size) -> std::vector<entry> {
+    auto table = milli::make_container_from<std::vector<entry>>(size, make_entry);
+    std::sort(table.begin(), table.end(), entry_less);
+    return table;
+  }
+
+  // Resident memory of this process from /proc/self/smaps_rollup: anonymous memory is private to it, file backed
+  // pages are page cache that other processes mapping the same file share.
+  struct resident_memory {
+    std::uint64_t anonymous = 0;
+    std::uint64_t file_backed = 0;
+  };
+
+  auto resident() -> resident_memory {
+    resident_memory result;
+#ifdef __linux__
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::uint64_t rss = 0;
+    std::string line;
+    std::getline(smaps, line);
+    std::string field;
+    std::uint64_t kilobytes = 0;
+    while (smaps >> field >> kilobytes) {
+      if (field == "Rss:")
+        rss = kilobytes * 1024;
+      else if (field == "Anonymous:")
+        result.anonymous = kilobytes * 1024;
+      std::getline(smaps, line);
+    }
+    result.file_backed = rss - result.anonymous;
+#endif
+    return result;
+  }
+
+  auto report(benchmark::State& state, const resident_memory& before, const resident_memory& after) -> void {
+    state.counters["anonymous_bytes"] = static_cast<double>(after.anonymous) - static_cast<double>(before.anonymous);
+    state.counters["file_backed_bytes"] =
+        static_cast<double>(after.file_backed) - static_cast<double>(before.file_backed);
+  }
+
+  auto image_path(std::size_t size) -> std::string {
+    return "frozen_image_benchmark_" + std::to_string(size) + ".img";
+  }
+
+  // Memory is measured once, on the first table; the loop measures time only.
+  void rebuild(benchmark::State& state){
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto before = resident();
+    auto first = build(size);
+    report(state, before, resident());
+    benchmark::DoNotOptimize(first.data());
+
+    for(auto _ : state){
+      auto table = build(size);
+      benchmark::DoNotOptimize(table.data());
+    }
+  }
+
+  template<milli::frozen_check check>
+  void open_image(benchmark::State& state){
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto path = image_path(size);
+    milli::frozen_image<frozen_quotes>::write(path, build(size));
+
+    auto before = resident();
+    auto first = milli::frozen_image<frozen_quotes>::open(path, check);
+    report(state, before, resident());
+
+    for(auto _ : state){
+      auto image = milli::frozen_image<frozen_quotes>::open(path, check);
+      benchmark::DoNotOptimize(image->keys().begin());
+    }
+    std::remove(path.c_str());
+  }
+
+  // Lookups once everything is resident: the image has to be as fast as the table built in memory.
+  void lookup_rebuilt(benchmark::State& state){
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto table = build(size);
+    std::size_t index = 0;
+    for(auto _ : state){
+      auto key = make_entry(index++ % size).first;
+      auto found = std::lower_bound(table.begin(), table.end(), entry(key, quote{}), entry_less);
+      benchmark::DoNotOptimize(found->second.bid);
+    }
+  }
+
+  void lookup_image(benchmark::State& state){
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto path = image_path(size);
+    milli::frozen_image<frozen_quotes>::write(path, build(size));
+    auto image = milli::frozen_image<frozen_quotes>::open(path);
+    std::size_t index = 0;
+    for(auto _ : state){
+      auto found = image->find(make_entry(index++ % size).first);
+      benchmark::DoNotOptimize(found->bid);
+    }
+    std::remove(path.c_str());
+  }
+
+}
+
+BENCHMARK(rebuild)->Arg(1 << 16)->Arg(1 << 22)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(open_image, milli::frozen_check::checksum)->Arg(1 << 16)->Arg(1 << 22)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(open_image, milli::frozen_check::header)->Arg(1 << 16)->Arg(1 << 22)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(lookup_rebuilt)->Arg(1 << 22);
+BENCHMARK(lookup_image)->Arg(1 << 22);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+/*
+lazy.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/lazy.hpp>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t reads_per_iteration = 1024;
+
+  struct make_table {
+    auto operator()() const -> std::vector<int> {
+      return std::vector<int>(64, 1);
+    }
+  };
+
+  milli::lazy<std::vector<int>, make_table> lazy_table;
+  thread_local milli::thread_local_lazy<std::vector<int>, make_table> thread_local_lazy_table;
+
+  auto magic_static_table() -> const std::vector<int>& {
+    static const std::vector<int> table = make_table()();
+    return table;
+  }
+
+  std::once_flag table_once;
+  const std::vector<int>* once_table = nullptr;
+
+  auto call_once_table() -> const std::vector<int>& {
+    std::call_once(table_once, []{ once_table = new std::vector<int>(make_table()()); });
+    return *once_table;
+  }
+
+  // Every read is a separate access: the clobber in DoNotOptimize keeps the compiler from hoisting the checks.
+  template<typename Read>
+  void read(benchmark::State& state, Read read){
+    for(auto _ : state){
+      for(std::size_t i = 0; i < reads_per_iteration; ++i){
+        int value = read()[i % 64];
+        benchmark::DoNotOptimize(value);
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * reads_per_iteration);
+  }
+
+  void lazy(benchmark::State& state){
+    read(state, []() -> const std::vector<int>& { return *lazy_table; });
+  }
+
+  void thread_local_lazy(benchmark::State& state){
+    read(state, []() -> const std::vector<int>& { return *thread_local_lazy_table; });
+  }
+
+  void magic_static(benchmark::State& state){
+    read(state, magic_static_table);
+  }
+
+  void call_once(benchmark::State& state){
+    read(state, call_once_table);
+  }
+
+}
+
+BENCHMARK(lazy)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(thread_local_lazy)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(magic_static)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(call_once)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,145 @@
+/*
+local_shared_ptr.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/intrusive_ptr.hpp>
+#include <milli/local_shared_ptr.hpp>
+#include <milli/not_empty_h.hpp>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  // libstdc++ skips the atomic instructions of std::shared_ptr until the process starts its first thread. Real programs
+  // that care about local_shared_ptr do have threads, so start one before measuring.
+  const bool multithreaded = []{
+    std::thread([]{}).join();
+    return true;
+  }();
+
+  constexpr std::size_t node_count = 4096;
+  constexpr std::size_t edges_per_node = 8;
+
+  struct shared_node {
+    int value;
+    std::vector<milli::not_empty_h<std::shared_ptr<shared_node>>> children;
+  };
+
+  struct local_node {
+    int value;
+    std::vector<milli::not_empty_h<milli::local_shared_ptr<local_node>>> children;
+  };
+
+  struct intrusive_node : milli::intrusive_ref_counter<intrusive_node> {
+    int value;
+    std::vector<milli::not_empty_h<milli::intrusive_ptr<intrusive_node>>> children;
+  };
+
+  auto make_node(const shared_node*) -> std::shared_ptr<shared_node>{
+    return std::make_shared<shared_node>();
+  }
+
+  auto make_node(const local_node*) -> milli::local_shared_ptr<local_node>{
+    return milli::make_local_shared<local_node>();
+  }
+
+  auto make_node(const intrusive_node*) -> milli::intrusive_ptr<intrusive_node>{
+    return milli::make_intrusive<intrusive_node>();
+  }
+
+  // Directed acyclic graph: every node points to edges_per_node random nodes created before it.
+  template <typename Node>
+  auto make_graph() -> std::vector<decltype(make_node(std::declval<const Node*>()))>{
+    std::mt19937 generator(42);
+    std::vector<decltype(make_node(std::declval<const Node*>()))> nodes;
+    nodes.reserve(node_count);
+
+    for(std::size_t index = 0; index != node_count; ++index){
+      auto node = make_node(static_cast<const Node*>(nullptr));
+      node->value = static_cast<int>(index);
+      if(index != 0){
+        std::uniform_int_distribution<std::size_t> target(0, index - 1);
+        for(std::size_t edge = 0; edge != edges_per_node; ++edge)
+          node->children.emplace_back(nodes[target(generator)]);
+      }
+      nodes.push_back(std::move(node));
+    }
+    return nodes;
+  }
+
+  // Copy-heavy traversal: every visit copies the adjacency list of a node into a reused worklist, so the reference
+  // counting is measured rather than the allocator.
+  template <typename Node>
+  void copy_children(benchmark::State& state){
+    auto nodes = make_graph<Node>();
+    auto worklist = nodes.back()->children;
+    for(auto _ : state){
+      long sum = 0;
+      for(const auto& node : nodes){
+        worklist.assign(node->children.begin(), node->children.end());
+        for(const auto& child : worklist)
+          sum += child->value;
+      }
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * node_count * edges_per_node);
+  }
+
+  template <typename Node>
+  void build_graph(benchmark::State& state){
+    for(auto _ : state){
+      auto nodes = make_graph<Node>();
+      benchmark::DoNotOptimize(nodes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * node_count);
+  }
+
+  void allocate_shared_ptr_new(benchmark::State& state){
+    for(auto _ : state){
+      std::shared_ptr<int> pointer(new int(1));
+      benchmark::DoNotOptimize(pointer.get());
+    }
+  }
+
+  void allocate_make_shared(benchmark::State& state){
+    for(auto _ : state){
+      auto pointer = std::make_shared<int>(1);
+      benchmark::DoNotOptimize(pointer.get());
+    }
+  }
+
+  void allocate_make_local_shared(benchmark::State& state){
+    for(auto _ : state){
+      auto pointer = milli::make_local_shared<int>(1);
+      benchmark::DoNotOptimize(pointer.get());
+    }
+  }
+
+}
+
+BENCHMARK_TEMPLATE(copy_children, shared_node);
+BENCHMARK_TEMPLATE(copy_children, local_node);
+BENCHMARK_TEMPLATE(copy_children, intrusive_node);
+BENCHMARK_TEMPLATE(build_graph, shared_node);
+BENCHMARK_TEMPLATE(build_graph, local_node);
+BENCHMARK_TEMPLATE(build_graph, intrusive_node);
+BENCHMARK(allocate_shared_ptr_new);
+BENCHMARK(allocate_make_shared);
+BENCHMARK(allocate_make_local_shared);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,90 @@
+/*
+make_container_from.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2018-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/make_container_from.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+  auto generate(std::size_t index) -> std::uint64_t{
+    // a few multiplications so that the generator is not purely memory bound
+    std::uint64_t value = index * 0x9E3779B97F4A7C15ull;
+    value ^= value >> 29;
+    return value * 0xBF58476D1CE4E5B9ull;
+  }
+
+  void push_back_loop(benchmark::State& state){
+    auto size = static_cast<std::size_t>(state.range(0));
+    for(auto _ : state){
+      std::vector<std::uint64_t> container;
+      for(std::size_t i = 0; i < size; ++i)
+        container.push_back(generate(i));
+      benchmark::DoNotOptimize(container.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void reserve_push_back_loop(benchmark::State& state){
+    auto size = static_cast<std::size_t>(state.range(0));
+    for(auto _ : state){
+      std::vector<std::uint64_t> container;
+      container.reserve(size);
+      for(std::size_t i = 0; i < size; ++i)
+        container.push_back(generate(i));
+      benchmark::DoNotOptimize(container.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void make_container_from_seq(benchmark::State& state){
+    auto size = static_cast<std::size_t>(state.range(0));
+    for(auto _ : state){
+      auto container = milli::make_container_from<std::vector<std::uint64_t>>(size, generate, milli::seq);
+      benchmark::DoNotOptimize(container.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void make_container_from_par(benchmark::State& state){
+    auto size = static_cast<std::size_t>(state.range(0));
+    for(auto _ : state){
+      auto container = milli::make_container_from<std::vector<std::uint64_t>>(size, generate, milli::par);
+      benchmark::DoNotOptimize(container.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void make_container_from_par_default_init(benchmark::State& state){
+    using container = std::vector<std::uint64_t, milli::default_init_allocator<std::uint64_t>>;
+    auto size = static_cast<std::size_t>(state.range(0));
+    for(auto _ : state){
+      auto result = milli::make_container_from<container>(size, generate, milli::par);
+      benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+}
+
+BENCHMARK(push_back_loop)->Arg(10000000)->Arg(50000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(reserve_push_back_loop)->Arg(10000000)->Arg(50000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(make_container_from_seq)->Arg(10000000)->Arg(50000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(make_container_from_par)->Arg(10000000)->Arg(50000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(make_container_from_par_default_init)->Arg(10000000)->Arg(50000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,101 @@
+/*
+memoize.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/memoize.hpp>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+  constexpr std::size_t calls_per_iteration = 1024;
+
+  auto expensive(std::uint64_t value) -> std::uint64_t {
+    for(int round = 0; round != 64; ++round)
+      value = value * 6364136223846793005ull + 1442695040888963407ull;
+    return value;
+  }
+
+  // What memoize replaces: one unordered_map behind one mutex.
+  class locked_map {
+  public:
+    auto operator()(std::uint64_t key) -> std::uint64_t {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = map_.find(key);
+        if(found != map_.end())
+          return found->second;
+      }
+      auto value = expensive(key);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(map_.size() >= capacity)
+        map_.clear();
+      map_.emplace(key, value);
+      return value;
+    }
+
+    static constexpr std::size_t capacity = 1 << 14;
+
+  private:
+    std::mutex mutex_;
+    std::unordered_map<std::uint64_t, std::uint64_t> map_;
+  };
+
+  // Hits: 1024 keys, all of them cached after the first iteration. Misses: keys never repeat within the capacity.
+  template<typename Cache>
+  void call(benchmark::State& state, Cache& cache, bool hits){
+    std::uint64_t next = static_cast<std::uint64_t>(state.thread_index()) << 40;
+    for(auto _ : state){
+      for(std::size_t i = 0; i < calls_per_iteration; ++i){
+        auto key = hits ? i : next++;
+        benchmark::DoNotOptimize(cache(key));
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * calls_per_iteration);
+  }
+
+  auto memoized_expensive() -> decltype(milli::memoize<std::uint64_t>(expensive, 1 << 14)) & {
+    static auto cache = milli::memoize<std::uint64_t>(expensive, 1 << 14);
+    return cache;
+  }
+
+  locked_map locked;
+
+  void memoize_hits(benchmark::State& state){
+    call(state, memoized_expensive(), true);
+  }
+
+  void locked_map_hits(benchmark::State& state){
+    call(state, locked, true);
+  }
+
+  void memoize_misses(benchmark::State& state){
+    call(state, memoized_expensive(), false);
+  }
+
+  void locked_map_misses(benchmark::State& state){
+    call(state, locked, false);
+  }
+
+}
+
+BENCHMARK(memoize_hits)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(locked_map_hits)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(memoize_misses)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(locked_map_misses)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+/*
+not_empty_access.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/not_empty_e.hpp>
+#include <milli/not_empty_h.hpp>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // Pointer chasing over a shuffled circular list: every node has a successor, so next is never null.
+
+  struct raw_node {
+    raw_node* next;
+    long value;
+  };
+
+  template<typename AccessPolicy>
+  struct hard_node {
+    milli::not_empty_h<hard_node*, AccessPolicy> next;
+    long value;
+  };
+
+  template<typename AccessPolicy>
+  struct exception_node {
+    milli::not_empty_e<exception_node*, AccessPolicy> next;
+    long value;
+  };
+
+  template<typename Node>
+  auto make_cycle(std::size_t size) -> std::vector<Node>{
+    std::vector<Node> nodes;
+    nodes.reserve(size);
+    for(std::size_t i = 0; i < size; ++i)
+      nodes.push_back(Node{&nodes.front(), static_cast<long>(i)});
+
+    std::vector<std::size_t> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    for(std::size_t i = 0; i < size; ++i)
+      nodes[order[i]].next = &nodes[order[(i + 1) % size]];
+
+    return nodes;
+  }
+
+  template<typename Node>
+  void chase(benchmark::State& state){
+    auto nodes = make_cycle<Node>(static_cast<std::size_t>(state.range(0)));
+    constexpr std::size_t steps = 1 << 16;
+
+    for(auto _ : state){
+      const Node* current = &nodes.front();
+      long sum = 0;
+      for(std::size_t i = 0; i < steps; ++i){
+        sum += current->value;
+        current = &*current->next;
+      }
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * steps);
+  }
+
+}
+
+BENCHMARK_TEMPLATE(chase, raw_node)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(chase, hard_node<milli::check_on_access>)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(chase, hard_node<milli::check_once>)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(chase, exception_node<milli::check_on_access>)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(chase, exception_node<milli::check_once>)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
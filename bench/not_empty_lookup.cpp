@@ -0,0 +1,161 @@
+/*
+not_empty_lookup.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <benchmark/benchmark.h>
+#include <milli/not_empty_h.hpp>
+#include <milli/not_empty_range.hpp>
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t key_count = 1024;
+
+  using pointer_key = milli::not_empty_h<std::shared_ptr<int>>;
+  using string_key = milli::not_empty_range_h<std::string_view>;
+
+  auto objects() -> const std::vector<std::shared_ptr<int>>& {
+    static const std::vector<std::shared_ptr<int>> result = [] {
+      std::vector<std::shared_ptr<int>> objects;
+      for(std::size_t i = 0; i != key_count; ++i)
+        objects.push_back(std::make_shared<int>(static_cast<int>(i)));
+      return objects;
+    }();
+    return result;
+  }
+
+  auto names() -> const std::vector<std::string>& {
+    static const std::vector<std::string> result = [] {
+      std::vector<std::string> names;
+      for(std::size_t i = 0; i != key_count; ++i)
+        names.push_back("name of key number " + std::to_string(i));
+      return names;
+    }();
+    return result;
+  }
+
+  template<typename Set>
+  auto pointer_set() -> Set {
+    Set set;
+    for(auto& object : objects())
+      set.insert(pointer_key(object));
+    return set;
+  }
+
+  template<typename Set>
+  auto string_set() -> Set {
+    Set set;
+    for(auto& name : names())
+      set.insert(string_key(std::string_view(name)));
+    return set;
+  }
+
+  // Every iteration looks up all keys once, by the raw pointer or view a caller has at hand. Without transparent
+  // functions that means building a temporary wrapper: a shared_ptr copy and the check of not_empty_h. Lookups use
+  // find(): the transparent count() of std::set walks an equal_range, which would be measured instead.
+  template<typename Set, typename Lookup>
+  void lookup(benchmark::State& state, const Set& set, Lookup lookup_one){
+    for(auto _ : state){
+      std::size_t found = 0;
+      for(std::size_t i = 0; i != key_count; ++i)
+        found += lookup_one(set, i);
+      benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * key_count);
+  }
+
+  void unordered_pointer_wrapped(benchmark::State& state){
+    auto set = pointer_set<std::unordered_set<pointer_key>>();
+    lookup(state, set, [](const std::unordered_set<pointer_key>& set, std::size_t i) {
+      return set.find(pointer_key(objects()[i])) != set.end();
+    });
+  }
+
+  void ordered_pointer_wrapped(benchmark::State& state){
+    auto set = pointer_set<std::set<pointer_key>>();
+    lookup(state, set, [](const std::set<pointer_key>& set, std::size_t i) {
+      return set.find(pointer_key(objects()[i])) != set.end();
+    });
+  }
+
+  void ordered_pointer_transparent(benchmark::State& state){
+    using set_type = std::set<pointer_key, milli::not_empty_less>;
+    auto set = pointer_set<set_type>();
+    lookup(state, set, [](const set_type& set, std::size_t i) {
+      return set.find(objects()[i].get()) != set.end();
+    });
+  }
+
+  void unordered_string_wrapped(benchmark::State& state){
+    auto set = string_set<std::unordered_set<string_key>>();
+    lookup(state, set, [](const std::unordered_set<string_key>& set, std::size_t i) {
+      return set.find(string_key(std::string_view(names()[i]))) != set.end();
+    });
+  }
+
+  void ordered_string_transparent(benchmark::State& state){
+    using set_type = std::set<string_key, milli::not_empty_less>;
+    auto set = string_set<set_type>();
+    lookup(state, set, [](const set_type& set, std::size_t i) {
+      return set.find(std::string_view(names()[i])) != set.end();
+    });
+  }
+
+  void ordered_string_wrapped(benchmark::State& state){
+    auto set = string_set<std::set<string_key, milli::not_empty_less>>();
+    lookup(state, set, [](const std::set<string_key, milli::not_empty_less>& set, std::size_t i) {
+      return set.find(string_key(std::string_view(names()[i]))) != set.end();
+    });
+  }
+
+#ifdef __cpp_lib_generic_unordered_lookup
+  void unordered_pointer_transparent(benchmark::State& state){
+    using set_type = std::unordered_set<pointer_key, milli::not_empty_hash, milli::not_empty_equal_to>;
+    auto set = pointer_set<set_type>();
+    lookup(state, set, [](const set_type& set, std::size_t i) {
+      return set.find(objects()[i].get()) != set.end();
+    });
+  }
+
+  void unordered_string_transparent(benchmark::State& state){
+    using set_type = std::unordered_set<string_key, milli::not_empty_hash, milli::not_empty_equal_to>;
+    auto set = string_set<set_type>();
+    lookup(state, set, [](const set_type& set, std::size_t i) {
+      return set.find(std::string_view(names()[i])) != set.end();
+    });
+  }
+#endif
+
+}
+
+BENCHMARK(unordered_pointer_wrapped);
+BENCHMARK(ordered_pointer_wrapped);
+BENCHMARK(ordered_pointer_transparent);
+BENCHMARK(unordered_string_wrapped);
+BENCHMARK(ordered_string_wrapped);
+BENCHMARK(ordered_string_transparent);
+#ifdef __cpp_lib_generic_unordered_lookup
+BENCHMARK(unordered_pointer_transparent);
+BENCHMARK(unordered_string_transparent);
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,64 @@
+/*
+not_empty_span.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/not_empty_h.hpp>
+#include <milli/not_empty_span.hpp>
+#include <vector>
+
+namespace {
+
+  auto make_pointers(std::size_t size) -> std::vector<int*>{
+    static int value = 0;
+    return std::vector<int*>(size, &value);
+  }
+
+  void per_element_not_empty_h(benchmark::State& state){
+    auto pointers = make_pointers(static_cast<std::size_t>(state.range(0)));
+    for(auto _ : state){
+      for(int* pointer : pointers){
+        milli::not_empty_h<int*> checked(pointer);
+        benchmark::DoNotOptimize(checked);
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void per_element_not_empty_h_copy(benchmark::State& state){
+    auto pointers = make_pointers(static_cast<std::size_t>(state.range(0)));
+    for(auto _ : state){
+      std::vector<milli::not_empty_h<int*>> checked(pointers.begin(), pointers.end());
+      benchmark::DoNotOptimize(checked.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  void not_empty_span_h(benchmark::State& state){
+    auto pointers = make_pointers(static_cast<std::size_t>(state.range(0)));
+    for(auto _ : state){
+      milli::not_empty_span_h<int*> checked(pointers.data(), pointers.size());
+      benchmark::DoNotOptimize(checked);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+}
+
+BENCHMARK(per_element_not_empty_h)->Range(64, 1 << 20);
+BENCHMARK(per_element_not_empty_h_copy)->Range(64, 1 << 20);
+BENCHMARK(not_empty_span_h)->Range(64, 1 << 20);
+
+BENCHMARK_MAIN();
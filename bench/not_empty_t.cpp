@@ -0,0 +1,86 @@
+/*
+not_empty_t.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/not_empty_h.hpp>
+#include <milli/not_empty_i.hpp>
+#include <milli/not_empty_t.hpp>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t input_size = 4096;
+
+  // No violations: every pointer is valid, so the telemetry handler only ever runs its not taken branch.
+  template<template<typename, typename> class NotEmpty>
+  void construct(benchmark::State& state){
+    static int values[input_size];
+    std::vector<int*> input;
+    for(auto& value : values)
+      input.push_back(&value);
+
+    for(auto _ : state){
+      long sum = 0;
+      for(int* pointer : input){
+        NotEmpty<int*, milli::check_once> checked(pointer);
+        benchmark::DoNotOptimize(checked);
+        sum += *checked;
+      }
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * input_size);
+  }
+
+  // Checks on every access as well, over a circular list in random order.
+  template<template<typename, typename> class NotEmpty>
+  struct node {
+    NotEmpty<node*, milli::check_on_access> next;
+    long value;
+  };
+
+  template<template<typename, typename> class NotEmpty>
+  void chase(benchmark::State& state){
+    constexpr std::size_t size = 1 << 12;
+    constexpr std::size_t steps = 1 << 16;
+    std::vector<node<NotEmpty>> nodes;
+    nodes.reserve(size);
+    for(std::size_t i = 0; i < size; ++i)
+      nodes.push_back(node<NotEmpty>{&nodes.front(), static_cast<long>(i)});
+    for(std::size_t i = 0; i < size; ++i)
+      nodes[i].next = &nodes[(i * 2654435761u + 1) % size];
+
+    for(auto _ : state){
+      const node<NotEmpty>* current = &nodes.front();
+      long sum = 0;
+      for(std::size_t i = 0; i < steps; ++i){
+        sum += current->value;
+        current = &*current->next;
+      }
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * steps);
+  }
+
+}
+
+BENCHMARK_TEMPLATE(construct, milli::not_empty_i);
+BENCHMARK_TEMPLATE(construct, milli::not_empty_t);
+BENCHMARK_TEMPLATE(construct, milli::not_empty_h);
+BENCHMARK_TEMPLATE(chase, milli::not_empty_i);
+BENCHMARK_TEMPLATE(chase, milli::not_empty_t);
+BENCHMARK_TEMPLATE(chase, milli::not_empty_h);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+/*
+profiler.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/profiler.hpp>
+#include <milli/raii.hpp>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t scopes_per_iteration = 1024;
+
+  // The cost of the two timestamps alone, which bounds what any scope timer can achieve.
+  void two_timestamps(benchmark::State& state){
+    for(auto _ : state){
+      for(std::size_t i = 0; i < scopes_per_iteration; ++i){
+        auto start = milli::detail::read_ticks();
+        benchmark::DoNotOptimize(start);
+        auto end = milli::detail::read_ticks();
+        benchmark::DoNotOptimize(end);
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * scopes_per_iteration);
+  }
+
+  void profile_scope(benchmark::State& state){
+    for(auto _ : state){
+      for(std::size_t i = 0; i < scopes_per_iteration; ++i){
+        MILLI_PROFILE_SCOPE("benchmark scope");
+        benchmark::DoNotOptimize(i);
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * scopes_per_iteration);
+  }
+
+  // What scoped_timer replaces: a raii lambda taking steady_clock timestamps into a vector guarded by a mutex.
+  std::mutex samples_mutex;
+  std::vector<std::int64_t> samples;
+
+  void raii_with_mutex(benchmark::State& state){
+    for(auto _ : state){
+      for(std::size_t i = 0; i < scopes_per_iteration; ++i){
+        auto start = std::chrono::steady_clock::now();
+        auto finish = [start]{
+          auto duration = std::chrono::steady_clock::now() - start;
+          std::lock_guard<std::mutex> lock(samples_mutex);
+          samples.push_back(duration.count());
+        };
+        milli::raii<decltype(finish)> timer(std::move(finish));
+        benchmark::DoNotOptimize(i);
+      }
+      if(state.thread_index() == 0){
+        std::lock_guard<std::mutex> lock(samples_mutex);
+        samples.clear();
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * scopes_per_iteration);
+  }
+
+}
+
+BENCHMARK(two_timestamps)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(profile_scope)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(raii_with_mutex)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
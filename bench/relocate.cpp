@@ -0,0 +1,172 @@
+/*
+relocate.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <benchmark/benchmark.h>
+#include <milli/not_empty_h.hpp>
+#include <milli/raii.hpp>
+#include <milli/relocate.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  int finalized = 0;
+
+  struct finalizer {
+    int* counter;
+
+    void operator()() const noexcept {
+      ++*counter;
+    }
+  };
+
+  using guard = milli::raii<finalizer>;
+  using owner = milli::not_empty_h<std::unique_ptr<int>>;
+
+  auto make(guard*) -> guard {
+    return guard(finalizer{&finalized});
+  }
+
+  auto make(owner*) -> owner {
+    return owner(std::unique_ptr<int>(new int(1)));
+  }
+
+  // What growing and erasing without relocation does: a move construction and a destruction per element.
+  struct move_and_destroy {
+    template<typename T>
+    static auto relocate(T* first, T* last, T* result) -> T* {
+      for(; first != last; ++first, ++result){
+        ::new(static_cast<void*>(result)) T(std::move(*first));
+        first->~T();
+      }
+      return result;
+    }
+  };
+
+  struct relocation {
+    template<typename T>
+    static auto relocate(T* first, T* last, T* result) -> T* {
+      return milli::uninitialized_relocate(first, last, result);
+    }
+  };
+
+  // The growth and erase of std::vector, with the way elements reach their new places as a parameter.
+  template<typename T, typename Relocation>
+  class buffer {
+  public:
+    buffer() = default;
+    buffer(const buffer&) = delete;
+    auto operator=(const buffer&) -> buffer& = delete;
+
+    ~buffer(){
+      for(std::size_t i = 0; i != size_; ++i)
+        data_[i].~T();
+      ::operator delete(data_);
+    }
+
+    auto push_back(T&& value) -> void {
+      if(size_ == capacity_){
+        std::size_t capacity = capacity_ ? capacity_ * 2 : 1;
+        T* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        Relocation::relocate(data_, data_ + size_, data);
+        ::operator delete(data_);
+        data_ = data;
+        capacity_ = capacity;
+      }
+      ::new(static_cast<void*>(data_ + size_)) T(std::move(value));
+      ++size_;
+    }
+
+    auto erase_front() -> void {
+      data_[0].~T();
+      Relocation::relocate(data_ + 1, data_ + size_, data_);
+      --size_;
+    }
+
+    auto size() const noexcept -> std::size_t {
+      return size_;
+    }
+
+  private:
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+  };
+
+  template<typename Container, typename T>
+  void growth(benchmark::State& state){
+    auto count = static_cast<std::size_t>(state.range(0));
+    for(auto _ : state){
+      Container container;
+      for(std::size_t i = 0; i != count; ++i)
+        container.push_back(make(static_cast<T*>(nullptr)));
+      benchmark::DoNotOptimize(container.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  template<typename T>
+  void erase_front(std::vector<T>& container){
+    container.erase(container.begin());
+  }
+
+  template<typename T, typename Relocation>
+  void erase_front(buffer<T, Relocation>& container){
+    container.erase_front();
+  }
+
+  // Every iteration erases the first of count elements and appends a new one, so that the size stays the same. raii is
+  // not assignable, std::vector cannot erase its guards at all; the buffers construct into the gap instead.
+  template<typename Container, typename T>
+  void erase(benchmark::State& state){
+    auto count = static_cast<std::size_t>(state.range(0));
+    Container container;
+    for(std::size_t i = 0; i != count; ++i)
+      container.push_back(make(static_cast<T*>(nullptr)));
+
+    for(auto _ : state){
+      erase_front(container);
+      container.push_back(make(static_cast<T*>(nullptr)));
+      benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  template<typename T>
+  using moving_buffer = buffer<T, move_and_destroy>;
+
+  template<typename T>
+  using relocating_buffer = buffer<T, relocation>;
+
+}
+
+BENCHMARK_TEMPLATE(growth, std::vector<guard>, guard)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(growth, moving_buffer<guard>, guard)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(growth, relocating_buffer<guard>, guard)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(growth, std::vector<owner>, owner)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(growth, moving_buffer<owner>, owner)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(growth, relocating_buffer<owner>, owner)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(erase, moving_buffer<guard>, guard)->Range(16, 1 << 12);
+BENCHMARK_TEMPLATE(erase, relocating_buffer<guard>, guard)->Range(16, 1 << 12);
+BENCHMARK_TEMPLATE(erase, std::vector<owner>, owner)->Range(16, 1 << 12);
+BENCHMARK_TEMPLATE(erase, moving_buffer<owner>, owner)->Range(16, 1 << 12);
+BENCHMARK_TEMPLATE(erase, relocating_buffer<owner>, owner)->Range(16, 1 << 12);
+
+BENCHMARK_MAIN();
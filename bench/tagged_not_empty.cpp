@@ -0,0 +1,107 @@
+/*
+tagged_not_empty.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/tagged_not_empty.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // Nodes of a lock-free list: the "logically deleted" mark either gets a field of its own or rides in the link.
+  struct flagged_node {
+    std::uint64_t key;
+    milli::not_empty_i<flagged_node*> next;
+    bool marked;
+  };
+
+  struct tagged_node {
+    std::uint64_t key;
+    milli::tagged_not_empty_i<tagged_node*, 1, bool> next;
+  };
+
+  // Nodes have no null state, so they start out pointing to themselves until the list is linked.
+  auto make_nodes(std::size_t size, const flagged_node*) -> std::vector<flagged_node>{
+    std::vector<flagged_node> nodes;
+    nodes.reserve(size);
+    for(std::size_t index = 0; index != size; ++index)
+      nodes.push_back(flagged_node{0, milli::not_empty_i<flagged_node*>(nodes.data() + index), false});
+    return nodes;
+  }
+
+  auto make_nodes(std::size_t size, const tagged_node*) -> std::vector<tagged_node>{
+    std::vector<tagged_node> nodes;
+    nodes.reserve(size);
+    for(std::size_t index = 0; index != size; ++index)
+      nodes.push_back(tagged_node{0, milli::tagged_not_empty_i<tagged_node*, 1, bool>(nodes.data() + index)});
+    return nodes;
+  }
+
+  auto link(flagged_node& node, flagged_node& next, bool marked) -> void{
+    node.next = milli::not_empty_i<flagged_node*>(&next);
+    node.marked = marked;
+  }
+
+  auto link(tagged_node& node, tagged_node& next, bool marked) -> void{
+    node.next.reset(&next, marked);
+  }
+
+  auto is_marked(const flagged_node& node) -> bool{
+    return node.marked;
+  }
+
+  auto is_marked(const tagged_node& node) -> bool{
+    return node.next.tag();
+  }
+
+  // Circular list over state.range(0) nodes, linked in random order so that every step is a dependent cache miss
+  // once the list outgrows the caches. Every fourth node is marked.
+  template <typename Node>
+  void traverse(benchmark::State& state){
+    const auto size = static_cast<std::size_t>(state.range(0));
+    auto nodes = make_nodes(size, static_cast<const Node*>(nullptr));
+    std::vector<std::size_t> order(size);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    for(std::size_t index = 0; index != size; ++index){
+      nodes[order[index]].key = index;
+      link(nodes[order[index]], nodes[order[(index + 1) % size]], index % 4 == 0);
+    }
+
+    for(auto _ : state){
+      std::uint64_t sum = 0;
+      const Node* node = &nodes[order[0]];
+      for(std::size_t step = 0; step != size; ++step){
+        if(not is_marked(*node))
+          sum += node->key;
+        node = node->next.get();
+      }
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+    state.counters["node_bytes"] = sizeof(Node);
+  }
+
+}
+
+BENCHMARK_TEMPLATE(traverse, flagged_node)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(traverse, tagged_node)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
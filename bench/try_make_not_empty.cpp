@@ -0,0 +1,77 @@
+/*
+try_make_not_empty.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <benchmark/benchmark.h>
+#include <milli/not_empty_e.hpp>
+#include <milli/try_make_not_empty.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t input_size = 4096;
+
+  // state.range(0) is the percentage of null pointers in the input.
+  auto make_input(benchmark::State& state) -> std::vector<int*>{
+    static int value = 1;
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    std::vector<int*> input(input_size);
+    for(auto& pointer : input)
+      pointer = percent(generator) < state.range(0) ? nullptr : &value;
+    return input;
+  }
+
+  void throwing_not_empty_e(benchmark::State& state){
+    auto input = make_input(state);
+    for(auto _ : state){
+      long sum = 0;
+      for(int* pointer : input){
+        try{
+          milli::not_empty_e<int*> checked(pointer);
+          sum += *checked;
+        } catch(const milli::value_not_empty&){
+          --sum;
+        }
+      }
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * input_size);
+  }
+
+  void try_make_not_empty(benchmark::State& state){
+    auto input = make_input(state);
+    for(auto _ : state){
+      long sum = 0;
+      for(int* pointer : input){
+        auto checked = milli::try_make_not_empty(pointer);
+        if(checked)
+          sum += **checked;
+        else
+          --sum;
+      }
+      benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * input_size);
+  }
+
+}
+
+BENCHMARK(throwing_not_empty_e)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(try_make_not_empty)->Arg(1)->Arg(10)->Arg(50);
+
+BENCHMARK_MAIN();
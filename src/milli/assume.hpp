@@ -0,0 +1,42 @@
+/*
+assume.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_ASSUME_HPP
+#define MILLI_ASSUME_HPP
+
+// MILLI_ASSUME(condition); tells the optimizer that condition holds. It is a statement, nothing is checked and if
+// the condition is false the behaviour is undefined. The condition may not be evaluated at all, so it must not have
+// side effects.
+
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(assume) >= 202207L
+#define MILLI_HAS_ASSUME_ATTRIBUTE
+#endif
+#endif
+
+#if defined(MILLI_HAS_ASSUME_ATTRIBUTE)
+#define MILLI_ASSUME(condition) [[assume(condition)]]
+#elif defined(__clang__)
+#define MILLI_ASSUME(condition) __builtin_assume(condition)
+#elif defined(_MSC_VER)
+#define MILLI_ASSUME(condition) __assume(condition)
+#elif defined(__GNUC__)
+#define MILLI_ASSUME(condition) ((condition) ? static_cast<void>(0) : __builtin_unreachable())
+#else
+#define MILLI_ASSUME(condition) static_cast<void>(0)
+#endif
+
+#endif //MILLI_ASSUME_HPP
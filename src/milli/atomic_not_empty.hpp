@@ -0,0 +1,251 @@
+/*
+atomic_not_empty.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_ATOMIC_NOT_EMPTY_HPP
+#define MILLI_LIBRARY_ATOMIC_NOT_EMPTY_HPP
+
+#include <milli/not_empty_h.hpp>
+#include <milli/not_empty_i.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace milli {
+
+  namespace detail {
+
+    // Epoch based read-copy-update shared by all atomic_not_empty objects.
+    //
+    // Every thread that reads owns one reader slot. A reader publishes the global epoch it observed in its slot,
+    // then loads the pointer; leaving the read section publishes 0. Writers swap the pointer, advance the global
+    // epoch and may free an old object only once no slot shows an active reader from an earlier epoch. All accesses
+    // that take part in this handshake are sequentially consistent.
+    class rcu_domain {
+    public:
+      // Padded so that the epochs of two slots never share a cache line.
+      struct reader_slot {
+        std::atomic<std::uint64_t> epoch{0};
+        std::atomic<bool> owned{true};
+        unsigned nesting = 0;
+        reader_slot* next = nullptr;
+        char padding[64];
+      };
+
+      static auto instance() noexcept -> rcu_domain& {
+        static rcu_domain domain;
+        return domain;
+      }
+
+      auto enter() -> reader_slot& {
+        reader_slot& slot = local_slot();
+        if (slot.nesting++ == 0)
+          slot.epoch.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        return slot;
+      }
+
+      static auto leave(reader_slot& slot) noexcept -> void {
+        if (--slot.nesting == 0)
+          slot.epoch.store(0, std::memory_order_release);
+      }
+
+      // Advances the global epoch. Objects unpublished before the call are safe to free once is_quiescent(result).
+      auto advance() noexcept -> std::uint64_t {
+        return epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+      }
+
+      auto is_quiescent(std::uint64_t epoch) const noexcept -> bool {
+        for (auto slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next) {
+          auto reader_epoch = slot->epoch.load(std::memory_order_seq_cst);
+          if (reader_epoch != 0 && reader_epoch < epoch)
+            return false;
+        }
+        return true;
+      }
+
+      auto synchronize(std::uint64_t epoch) const noexcept -> void {
+        while (not is_quiescent(epoch))
+          std::this_thread::yield();
+      }
+
+    private:
+      rcu_domain() = default;
+
+      // Slots are never freed: a slot whose thread exited is reused by the next thread that starts reading.
+      struct slot_owner {
+        reader_slot* slot;
+
+        ~slot_owner() {
+          slot->owned.store(false, std::memory_order_release);
+        }
+      };
+
+      auto local_slot() -> reader_slot& {
+        static thread_local slot_owner owner{acquire_slot()};
+        return *owner.slot;
+      }
+
+      auto acquire_slot() -> reader_slot* {
+        for (auto slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next) {
+          bool owned = false;
+          if (not slot->owned.load(std::memory_order_relaxed) &&
+              slot->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+            return slot;
+        }
+
+        auto slot = new reader_slot;
+        slot->next = slots_.load(std::memory_order_relaxed);
+        while (not slots_.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed));
+        return slot;
+      }
+
+      alignas(64) std::atomic<std::uint64_t> epoch_{1};
+      alignas(64) std::atomic<reader_slot*> slots_{nullptr};
+    };
+
+  }
+
+  // Atomically replaceable owner of a never-null T, built for read-mostly shared state such as configuration.
+  //
+  // read() is wait-free: it publishes the reader epoch and loads the pointer, without touching any reference count
+  // or cache line written by other readers. The returned guard keeps the object alive. store() and exchange() check
+  // the new value with ErrorHandler, so the invariant is enforced where values come in. store() defers destruction of
+  // the previous object until no reader can observe it; exchange() waits for that moment and hands the object back.
+  //
+  // exchange() must not be called by a thread that holds a read guard: it would wait for itself forever.
+  template<typename T, typename ErrorHandler = detail::hard_error_handler>
+  class atomic_not_empty {
+  public:
+    class read_guard {
+    public:
+      read_guard(const read_guard&) = delete;
+      auto operator=(const read_guard&) -> read_guard& = delete;
+
+      read_guard(read_guard&& rhs) noexcept : value_(rhs.value_), slot_(rhs.slot_) {
+        rhs.slot_ = nullptr;
+      }
+
+      ~read_guard() {
+        if (slot_)
+          detail::rcu_domain::leave(*slot_);
+      }
+
+      auto get() const noexcept -> not_empty_i<const T*, check_once> {
+        return not_empty_i<const T*, check_once>(value_);
+      }
+
+      auto operator*() const noexcept -> const T& {
+        return *value_;
+      }
+
+      auto operator->() const noexcept -> const T* {
+        return value_;
+      }
+
+    private:
+      friend class atomic_not_empty;
+
+      read_guard(const T* value, detail::rcu_domain::reader_slot& slot) noexcept : value_(value), slot_(&slot) {}
+
+      const T* value_;
+      detail::rcu_domain::reader_slot* slot_;
+    };
+
+    explicit atomic_not_empty(std::unique_ptr<T> initial) : value_(checked(std::move(initial))) {}
+
+    atomic_not_empty(const atomic_not_empty&) = delete;
+    auto operator=(const atomic_not_empty&) -> atomic_not_empty& = delete;
+
+    // Destroys the current and all retired values; no reader may be active anymore.
+    ~atomic_not_empty() {
+      delete value_.load(std::memory_order_relaxed);
+      for (auto& retired : retired_)
+        delete retired.value;
+    }
+
+    auto read() const -> read_guard {
+      auto& slot = domain().enter();
+      return read_guard(value_.load(std::memory_order_seq_cst), slot);
+    }
+
+    // Publishes value. The previous value is destroyed later, by a store() or reclaim() that runs after every
+    // reader which could still see it has left.
+    auto store(std::unique_ptr<T> value) -> void {
+      T* fresh = checked(std::move(value));
+      std::lock_guard<std::mutex> lock(writer_);
+      T* previous = value_.exchange(fresh, std::memory_order_seq_cst);
+      retired_.push_back(retired_value{previous, domain().advance()});
+      reclaim_locked();
+    }
+
+    // Publishes value and returns the previous one once no reader can access it anymore.
+    auto exchange(std::unique_ptr<T> value) -> std::unique_ptr<T> {
+      T* fresh = checked(std::move(value));
+      std::uint64_t epoch;
+      T* previous;
+      {
+        std::lock_guard<std::mutex> lock(writer_);
+        previous = value_.exchange(fresh, std::memory_order_seq_cst);
+        epoch = domain().advance();
+      }
+      domain().synchronize(epoch);
+      return std::unique_ptr<T>(previous);
+    }
+
+    // Destroys the retired values no reader can observe anymore. Returns how many are still pending.
+    auto reclaim() -> std::size_t {
+      std::lock_guard<std::mutex> lock(writer_);
+      reclaim_locked();
+      return retired_.size();
+    }
+
+  private:
+    struct retired_value {
+      T* value;
+      std::uint64_t epoch;
+    };
+
+    static auto domain() noexcept -> detail::rcu_domain& {
+      return detail::rcu_domain::instance();
+    }
+
+    static auto checked(std::unique_ptr<T> value) -> T* {
+      ErrorHandler()(static_cast<bool>(value));
+      return value.release();
+    }
+
+    auto reclaim_locked() -> void {
+      auto pending = retired_.begin();
+      for (auto& retired : retired_) {
+        if (domain().is_quiescent(retired.epoch))
+          delete retired.value;
+        else
+          *pending++ = retired;
+      }
+      retired_.erase(pending, retired_.end());
+    }
+
+    std::atomic<T*> value_;
+    std::mutex writer_;
+    std::vector<retired_value> retired_;
+  };
+
+}
+
+#endif //MILLI_LIBRARY_ATOMIC_NOT_EMPTY_HPP
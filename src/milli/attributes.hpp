@@ -0,0 +1,45 @@
+/*
+attributes.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_ATTRIBUTES_HPP
+#define MILLI_ATTRIBUTES_HPP
+
+// MILLI_NOINLINE keeps a function out of line, MILLI_COLD additionally tells the optimizer it is rarely called, so
+// that it is placed away from hot code and branches leading to it are laid out as not taken.
+
+#if defined(__GNUC__)
+#define MILLI_NOINLINE __attribute__((noinline))
+#define MILLI_COLD __attribute__((noinline, cold))
+#elif defined(_MSC_VER)
+#define MILLI_NOINLINE __declspec(noinline)
+#define MILLI_COLD __declspec(noinline)
+#else
+#define MILLI_NOINLINE
+#define MILLI_COLD
+#endif
+
+// MILLI_LIKELY(condition) and MILLI_UNLIKELY(condition) evaluate to condition converted to bool and tell the
+// optimizer which outcome to lay out as the fall-through path.
+
+#if defined(__GNUC__)
+#define MILLI_LIKELY(condition) __builtin_expect(static_cast<bool>(condition), 1)
+#define MILLI_UNLIKELY(condition) __builtin_expect(static_cast<bool>(condition), 0)
+#else
+#define MILLI_LIKELY(condition) static_cast<bool>(condition)
+#define MILLI_UNLIKELY(condition) static_cast<bool>(condition)
+#endif
+
+#endif //MILLI_ATTRIBUTES_HPP
@@ -0,0 +1,131 @@
+/*
+contract.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_CONTRACT_HPP
+#define MILLI_CONTRACT_HPP
+
+#include <milli/assume.hpp>
+#include <milli/attributes.hpp>
+#include <milli/strong_assert.hpp>
+
+// Contract checks with levels. Every check has a level saying how expensive it is:
+//
+//   MILLI_EXPECTS_HOT, MILLI_ENSURES_HOT, MILLI_ASSERT_HOT     cheap enough for the hottest loops
+//   MILLI_EXPECTS, MILLI_ENSURES, MILLI_ASSERT                 ordinary checks
+//   MILLI_EXPECTS_AUDIT, MILLI_ENSURES_AUDIT, MILLI_ASSERT_AUDIT  expensive checks, e.g. walking a whole container
+//
+// MILLI_CONTRACT_LEVEL selects the most expensive level that is checked, globally with -D or per translation unit by
+// defining it before the first include. It is one of MILLI_CONTRACT_OFF, MILLI_CONTRACT_HOT, MILLI_CONTRACT_DEFAULT
+// and MILLI_CONTRACT_AUDIT, and defaults to MILLI_CONTRACT_DEFAULT, or MILLI_CONTRACT_HOT with NDEBUG, so that
+// MILLI_ASSERT behaves like assert. Inline functions must see the same level in every translation unit.
+//
+// An enabled check is a branch predicted not taken into a cold, out of line function that prints the location and
+// the condition and terminates, like strong_assert. The message is a string literal, nothing is formatted inline. The
+// literals themselves stay in .rodata: only the failing branch, which GCC and clang move to the cold part of the
+// function, loads their addresses, so the hot path does not touch them.
+//
+// A disabled hot or ordinary check becomes MILLI_ASSUME(condition) where the compiler has an assumption that never
+// evaluates its condition, [[assume]] or clang's __builtin_assume: no instructions, but the optimizer may rely on the
+// condition, and a false one is undefined behaviour. Elsewhere, e.g. GCC before 13, an assumption would still call
+// the functions in the condition, so the check is dropped entirely, like assert drops it. A disabled audit check is
+// never evaluated, its condition is usually too costly to assume.
+
+#define MILLI_CONTRACT_OFF 0
+#define MILLI_CONTRACT_HOT 1
+#define MILLI_CONTRACT_DEFAULT 2
+#define MILLI_CONTRACT_AUDIT 3
+
+#ifndef MILLI_CONTRACT_LEVEL
+#ifdef NDEBUG
+#define MILLI_CONTRACT_LEVEL MILLI_CONTRACT_HOT
+#else
+#define MILLI_CONTRACT_LEVEL MILLI_CONTRACT_DEFAULT
+#endif
+#endif
+
+#if defined(__has_cpp_attribute) && __cplusplus >= 202002L
+#if __has_cpp_attribute(unlikely) >= 201803L
+#define MILLI_DETAIL_UNLIKELY_BRANCH [[unlikely]]
+#endif
+#endif
+
+#ifndef MILLI_DETAIL_UNLIKELY_BRANCH
+#define MILLI_DETAIL_UNLIKELY_BRANCH
+#endif
+
+#define MILLI_DETAIL_STRINGIZE_EXPANDED(text) #text
+#define MILLI_DETAIL_STRINGIZE(text) MILLI_DETAIL_STRINGIZE_EXPANDED(text)
+
+#define MILLI_DETAIL_CONTRACT_CHECK(kind, condition)                                                                   \
+  do {                                                                                                                 \
+    if (MILLI_LIKELY(condition)) {                                                                                     \
+    } else MILLI_DETAIL_UNLIKELY_BRANCH {                                                                              \
+      ::milli::detail::contract_violation(kind " failed: " #condition, __FILE__ ":" MILLI_DETAIL_STRINGIZE(__LINE__)); \
+    }                                                                                                                  \
+  } while (false)
+
+#if defined(MILLI_HAS_ASSUME_ATTRIBUTE) || defined(__clang__)
+#define MILLI_CONTRACT_ASSUMES_DISABLED_CHECKS
+#define MILLI_DETAIL_CONTRACT_ASSUME(condition) MILLI_ASSUME(condition)
+#else
+#define MILLI_DETAIL_CONTRACT_ASSUME(condition) MILLI_DETAIL_CONTRACT_IGNORE(condition)
+#endif
+
+#define MILLI_DETAIL_CONTRACT_IGNORE(condition) static_cast<void>(sizeof(static_cast<bool>(condition)))
+
+#if MILLI_CONTRACT_LEVEL >= MILLI_CONTRACT_HOT
+#define MILLI_DETAIL_CONTRACT_HOT(kind, condition) MILLI_DETAIL_CONTRACT_CHECK(kind, condition)
+#else
+#define MILLI_DETAIL_CONTRACT_HOT(kind, condition) MILLI_DETAIL_CONTRACT_ASSUME(condition)
+#endif
+
+#if MILLI_CONTRACT_LEVEL >= MILLI_CONTRACT_DEFAULT
+#define MILLI_DETAIL_CONTRACT_DEFAULT(kind, condition) MILLI_DETAIL_CONTRACT_CHECK(kind, condition)
+#else
+#define MILLI_DETAIL_CONTRACT_DEFAULT(kind, condition) MILLI_DETAIL_CONTRACT_ASSUME(condition)
+#endif
+
+#if MILLI_CONTRACT_LEVEL >= MILLI_CONTRACT_AUDIT
+#define MILLI_DETAIL_CONTRACT_AUDIT(kind, condition) MILLI_DETAIL_CONTRACT_CHECK(kind, condition)
+#else
+#define MILLI_DETAIL_CONTRACT_AUDIT(kind, condition) MILLI_DETAIL_CONTRACT_IGNORE(condition)
+#endif
+
+#define MILLI_EXPECTS_HOT(condition) MILLI_DETAIL_CONTRACT_HOT("precondition", condition)
+#define MILLI_ENSURES_HOT(condition) MILLI_DETAIL_CONTRACT_HOT("postcondition", condition)
+#define MILLI_ASSERT_HOT(condition) MILLI_DETAIL_CONTRACT_HOT("assertion", condition)
+
+#define MILLI_EXPECTS(condition) MILLI_DETAIL_CONTRACT_DEFAULT("precondition", condition)
+#define MILLI_ENSURES(condition) MILLI_DETAIL_CONTRACT_DEFAULT("postcondition", condition)
+#define MILLI_ASSERT(condition) MILLI_DETAIL_CONTRACT_DEFAULT("assertion", condition)
+
+#define MILLI_EXPECTS_AUDIT(condition) MILLI_DETAIL_CONTRACT_AUDIT("precondition", condition)
+#define MILLI_ENSURES_AUDIT(condition) MILLI_DETAIL_CONTRACT_AUDIT("postcondition", condition)
+#define MILLI_ASSERT_AUDIT(condition) MILLI_DETAIL_CONTRACT_AUDIT("assertion", condition)
+
+namespace milli {
+
+  namespace detail {
+
+    [[noreturn]] MILLI_COLD inline void contract_violation(const char* message, const char* location) noexcept {
+      strong_assert_failure(message, location);
+    }
+
+  }
+
+}
+
+#endif //MILLI_CONTRACT_HPP
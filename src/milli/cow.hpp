@@ -0,0 +1,116 @@
+/*
+cow.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_COW_HPP
+#define MILLI_LIBRARY_COW_HPP
+
+#include <milli/not_empty_i.hpp>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace milli {
+
+  template<typename T>
+  class cow;
+
+  template<typename T, typename... Args>
+  auto make_cow(Args&&... args) -> cow<T>;
+
+  // Value of type T with copy-on-write semantics. Copies share one object; write() clones it first if it is shared and
+  // hands out the object itself when this cow is its only owner. A cow always holds a value: the object is kept in a
+  // not_empty_i<std::shared_ptr<T>, check_once>, so no access has a null check.
+  //
+  // Moves transfer the object, so the next write() after a move does not clone it. A moved-from cow holds no object
+  // and may only be assigned to or destroyed.
+  //
+  // Distinct cow objects may be used from different threads, like distinct std::shared_ptr objects can.
+  template<typename T>
+  class cow {
+  public:
+    using value_type = T;
+
+    cow() : cow(std::make_shared<T>()) {}
+
+    cow(const T& value) : cow(std::make_shared<T>(value)) {}
+
+    cow(T&& value) : cow(std::make_shared<T>(std::move(value))) {}
+
+    cow(const cow&) = default;
+
+    cow(cow&& other) noexcept : value_(std::move(other.value_)) {}
+
+    auto operator=(const cow&) -> cow& = default;
+
+    auto operator=(cow&& other) noexcept -> cow& {
+      value_ = std::move(other.value_);
+      return *this;
+    }
+
+    auto get() const noexcept -> const T& {
+      return *value_;
+    }
+
+    auto operator*() const noexcept -> const T& {
+      return *value_;
+    }
+
+    auto operator->() const noexcept -> const T* {
+      return &*value_;
+    }
+
+    // Mutable access. Clones the object if any other cow or share() result refers to it.
+    auto write() -> T& {
+      if (value_.get().use_count() != 1) {
+        value_ = shared_value(std::make_shared<T>(*value_));
+        return *value_;
+      }
+
+      // use_count() is a relaxed load. The fence pairs with the release in the reference count decrement of the last
+      // other owner, whose reads of the object must be complete before this thread writes to it.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return *value_;
+    }
+
+    // Read-only shared ownership of the current object, e.g. for storage outside of cow values.
+    auto share() const noexcept -> not_empty_i<std::shared_ptr<const T>, check_once> {
+      return not_empty_i<std::shared_ptr<const T>, check_once>(std::shared_ptr<const T>(value_.get()));
+    }
+
+    auto use_count() const noexcept -> long {
+      return value_.get().use_count();
+    }
+
+  private:
+    using shared_value = not_empty_i<std::shared_ptr<T>, check_once>;
+
+    template<typename U, typename... Args>
+    friend auto make_cow(Args&&... args) -> cow<U>;
+
+    explicit cow(std::shared_ptr<T>&& value) noexcept : value_(std::move(value)) {}
+
+    shared_value value_;
+  };
+
+  // Constructs the value in place, without the copy or move the converting constructors of cow do.
+  template<typename T, typename... Args>
+  auto make_cow(Args&&... args) -> cow<T> {
+    return cow<T>(std::make_shared<T>(std::forward<Args>(args)...));
+  }
+
+}
+
+#endif //MILLI_LIBRARY_COW_HPP
@@ -0,0 +1,141 @@
+/*
+expected.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_EXPECTED_HPP
+#define MILLI_EXPECTED_HPP
+
+#include <milli/optional.hpp>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+namespace milli{
+
+  template <typename E>
+  struct unexpected{
+    E value;
+  };
+
+  template <typename E>
+  auto make_unexpected(E error) noexcept(std::is_nothrow_move_constructible<E>::value) -> unexpected<E>{
+    return unexpected<E>{std::move(error)};
+  }
+
+  // Either a value of type T or an error of type E. The value is kept in detail::optional storage, nothing is
+  // allocated and nothing is thrown: accessing the wrong alternative is checked with assert only, like
+  // detail::optional does. E is meant to be a small, cheap to copy error code.
+  template <typename T, typename E>
+  class expected{
+    static_assert(std::is_nothrow_copy_constructible<E>::value, "expected error type must be nothrow copy constructible");
+
+  public:
+    using value_type = T;
+    using error_type = E;
+
+    expected(T&& value) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : value_(std::move(value)), error_() {}
+
+    expected(unexpected<E> error) noexcept
+        : value_(), error_(error.value) {}
+
+    expected(expected&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : value_(std::move(rhs.value_)), error_(rhs.error_) {}
+
+    auto has_value() const noexcept -> bool{
+      return static_cast<bool>(value_);
+    }
+
+    explicit operator bool() const noexcept{
+      return has_value();
+    }
+
+    auto value() & noexcept -> T&{
+      return value_.value();
+    }
+
+    auto value() const & noexcept -> const T&{
+      return value_.value();
+    }
+
+    auto value() && noexcept -> T&&{
+      return std::move(value_.value());
+    }
+
+    auto operator*() & noexcept -> T&{
+      return value();
+    }
+
+    auto operator*() const & noexcept -> const T&{
+      return value();
+    }
+
+    auto operator*() && noexcept -> T&&{
+      return std::move(*this).value();
+    }
+
+    auto operator->() noexcept -> T*{
+      return &value();
+    }
+
+    auto operator->() const noexcept -> const T*{
+      return &value();
+    }
+
+    auto error() const noexcept -> const E&{
+      assert(not has_value());
+      return error_;
+    }
+
+    template <typename U>
+    auto value_or(U&& fallback) && -> T{
+      return has_value() ? std::move(value()) : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    // Calls function with the value and returns its result, which has to be an expected with the same error type.
+    // Without a value the error is passed through and function is not called.
+    template <typename F>
+    auto and_then(F&& function) & -> decltype(std::forward<F>(function)(std::declval<T&>())){
+      using result = decltype(std::forward<F>(function)(std::declval<T&>()));
+      if(has_value())
+        return std::forward<F>(function)(value());
+      return result(make_unexpected(error_));
+    }
+
+    template <typename F>
+    auto and_then(F&& function) && -> decltype(std::forward<F>(function)(std::declval<T&&>())){
+      using result = decltype(std::forward<F>(function)(std::declval<T&&>()));
+      if(has_value())
+        return std::forward<F>(function)(std::move(value()));
+      return result(make_unexpected(error_));
+    }
+
+    // Calls function with the error and returns its result, an expected<T, E>. With a value, that value is
+    // passed through and function is not called.
+    template <typename F>
+    auto or_else(F&& function) && -> expected{
+      if(has_value())
+        return std::move(*this);
+      return std::forward<F>(function)(error_);
+    }
+
+  private:
+    detail::optional<T> value_;
+    E error_;
+  };
+
+}
+
+#endif //MILLI_EXPECTED_HPP
@@ -0,0 +1,46 @@
+/*
+failure_hook.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_FAILURE_HOOK_HPP
+#define MILLI_FAILURE_HOOK_HPP
+
+#include <atomic>
+
+namespace milli {
+
+  namespace detail {
+
+    using failure_hook = void (*)();
+
+    // Function strong_assert_failure calls after writing its message and before terminating, e.g. to dump the flight
+    // recorder. It runs on the failing thread, possibly in a signal handler, so it has to be async-signal-safe. The slot
+    // is constant initialized, reading it never waits for a guard.
+    inline auto failure_hook_slot() noexcept -> std::atomic<failure_hook>& {
+      static std::atomic<failure_hook> hook{nullptr};
+      return hook;
+    }
+
+    // Runs the hook at most once, so that a failure inside the hook does not recurse.
+    inline auto run_failure_hook() noexcept -> void {
+      if (failure_hook hook = failure_hook_slot().exchange(nullptr, std::memory_order_acquire))
+        hook();
+    }
+
+  }
+
+}
+
+#endif //MILLI_FAILURE_HOOK_HPP
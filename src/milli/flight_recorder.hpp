@@ -0,0 +1,441 @@
+/*
+flight_recorder.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_FLIGHT_RECORDER_HPP
+#define MILLI_LIBRARY_FLIGHT_RECORDER_HPP
+
+#include <milli/attributes.hpp>
+#include <milli/failure_hook.hpp>
+#include <milli/tick_clock.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Events kept per thread, a power of two. Older events are overwritten.
+#ifndef MILLI_FLIGHT_RECORDER_EVENTS
+#define MILLI_FLIGHT_RECORDER_EVENTS 256
+#endif
+
+// MILLI_TRACE("name", arguments...) records an event with up to three integer, enum or pointer arguments in the flight
+// recorder of the calling thread. With MILLI_FLIGHT_RECORDER_DISABLED defined it expands to nothing and its arguments
+// are not evaluated.
+#ifdef MILLI_FLIGHT_RECORDER_DISABLED
+#define MILLI_TRACE(...) static_cast<void>(0)
+#else
+#define MILLI_TRACE(...) ::milli::flight_recorder::trace(__VA_ARGS__)
+#endif
+
+namespace milli {
+
+  // One recorded event, in memory and in dump files. The name is the first 23 characters of the string passed to
+  // MILLI_TRACE; bit i of signed_arguments tells whether argument i has to be read as two's complement.
+  struct flight_event {
+    std::uint64_t timestamp;
+    std::uint64_t arguments[3];
+    std::uint32_t thread;
+    std::uint16_t argument_count;
+    std::uint16_t signed_arguments;
+    char name[24];
+  };
+
+  static_assert(sizeof(flight_event) == 64, "flight_event is one cache line in memory and in dump files");
+
+  namespace detail {
+
+    constexpr std::size_t flight_events_per_ring = MILLI_FLIGHT_RECORDER_EVENTS;
+
+    static_assert(flight_events_per_ring != 0 && (flight_events_per_ring & (flight_events_per_ring - 1)) == 0,
+                  "MILLI_FLIGHT_RECORDER_EVENTS has to be a power of two");
+
+    template<typename T>
+    auto flight_argument(T value) noexcept
+    -> typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, std::uint64_t>::type {
+      return static_cast<std::uint64_t>(value);
+    }
+
+    template<typename T>
+    auto flight_argument(T* value) noexcept -> std::uint64_t {
+      return reinterpret_cast<std::uintptr_t>(value);
+    }
+
+    template<typename T>
+    constexpr auto flight_signed() noexcept -> bool {
+      return std::is_signed<T>::value;
+    }
+
+    constexpr auto flight_signed_mask(std::size_t) noexcept -> std::uint16_t {
+      return 0;
+    }
+
+    template<typename T, typename... Rest>
+    constexpr auto flight_signed_mask(std::size_t index, T, Rest... rest) noexcept -> std::uint16_t {
+      return static_cast<std::uint16_t>((flight_signed<T>() ? 1u << index : 0u) | flight_signed_mask(index + 1, rest...));
+    }
+
+    // Events of one thread. Only the owning thread writes events; written is published with release so that dumps
+    // from other threads see complete events, except for the one being written at that moment.
+    struct flight_ring {
+      flight_event events[flight_events_per_ring];
+      std::atomic<std::uint64_t> written{0};
+      std::atomic<bool> owned{true};
+      std::uint32_t thread = 0;
+      flight_ring* next = nullptr;
+    };
+
+    // Dump file layout: the header, then ring_count times a flight_file_ring followed by events_per_ring events, in
+    // the order they were written. Integers have the byte order of the machine that wrote the dump.
+    struct flight_file_header {
+      char magic[8];
+      std::uint32_t event_size;
+      std::uint32_t events_per_ring;
+      std::uint32_t ring_count;
+      std::uint32_t clock;
+      std::uint64_t dump_time;
+    };
+
+    struct flight_file_ring {
+      std::uint64_t written;
+      std::uint64_t reserved;
+    };
+
+    constexpr char flight_file_magic[8] = {'M', 'I', 'L', 'L', 'I', 'F', 'R', '1'};
+
+    // Text output that is async-signal-safe: formatted into a fixed buffer and written with write(2).
+    class flight_text {
+    public:
+      explicit flight_text(int descriptor) noexcept : descriptor_(descriptor) {}
+
+      flight_text(const flight_text&) = delete;
+      auto operator=(const flight_text&) -> flight_text& = delete;
+
+      ~flight_text() {
+        flush();
+      }
+
+      auto put(char character) noexcept -> flight_text& {
+        if (used_ == sizeof(buffer_))
+          flush();
+        buffer_[used_++] = character;
+        return *this;
+      }
+
+      auto text(const char* value, std::size_t limit = static_cast<std::size_t>(-1)) noexcept -> flight_text& {
+        for (; limit != 0 && *value; ++value, --limit)
+          put(*value);
+        return *this;
+      }
+
+      auto number(std::uint64_t value, bool negative = false) noexcept -> flight_text& {
+        char digits[20];
+        std::size_t count = 0;
+        do {
+          digits[count++] = static_cast<char>('0' + value % 10);
+          value /= 10;
+        } while (value != 0);
+
+        if (negative)
+          put('-');
+        while (count != 0)
+          put(digits[--count]);
+        return *this;
+      }
+
+      auto event(const flight_event& event, std::uint64_t dump_time, std::uint32_t clock) noexcept -> flight_text& {
+        auto age = event.timestamp < dump_time ? dump_time - event.timestamp : 0;
+        text("[thread ").number(event.thread).text("] ").number(age, age != 0).put(' ').text(tick_clock_unit(clock));
+        put(' ').text(event.name, sizeof(event.name));
+
+        std::size_t count = event.argument_count < 3 ? event.argument_count : 3;
+        for (std::size_t index = 0; index != count; ++index) {
+          auto value = event.arguments[index];
+          bool negative = (event.signed_arguments >> index & 1u) != 0 && value >> 63 != 0;
+          put(' ').number(negative ? ~value + 1 : value, negative);
+        }
+        return put('\n');
+      }
+
+      auto flush() noexcept -> void {
+        const char* data = buffer_;
+        while (used_ != 0) {
+#if defined(_WIN32)
+          auto written = _write(descriptor_, data, static_cast<unsigned>(used_));
+#else
+          auto written = ::write(descriptor_, data, used_);
+#endif
+          if (written <= 0)
+            break;
+          data += written;
+          used_ -= static_cast<std::size_t>(written);
+        }
+        used_ = 0;
+      }
+
+    private:
+      char buffer_[1024];
+      std::size_t used_ = 0;
+      int descriptor_;
+    };
+
+    // Rings are linked into a lock-free list and never freed. A ring whose thread exited is reused by the next thread
+    // that records, its old events stay in the dumps until they are overwritten.
+    class flight_registry {
+    public:
+      static auto instance() noexcept -> flight_registry& {
+        static flight_registry registry;
+        return registry;
+      }
+
+      static auto local_ring() noexcept -> flight_ring* {
+        static thread_local ring_owner owner{instance().acquire_ring()};
+        return owner.ring;
+      }
+
+      auto rings() const noexcept -> flight_ring* {
+        return rings_.load(std::memory_order_acquire);
+      }
+
+      auto map_file(const char* path, std::size_t ring_capacity) noexcept -> bool {
+#if defined(_WIN32)
+        static_cast<void>(path);
+        static_cast<void>(ring_capacity);
+        return false;
+#else
+        if (file_.load(std::memory_order_acquire) || ring_capacity == 0)
+          return false;
+
+        std::size_t size = sizeof(flight_file_header) + ring_capacity * ring_size();
+        int descriptor = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (descriptor < 0)
+          return false;
+        void* mapping = MAP_FAILED;
+        if (::ftruncate(descriptor, static_cast<off_t>(size)) == 0)
+          mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        ::close(descriptor);
+        if (mapping == MAP_FAILED)
+          return false;
+
+        std::size_t length = std::strlen(path);
+        length = length < sizeof(file_path_) - 1 ? length : sizeof(file_path_) - 1;
+        std::memcpy(file_path_, path, length);
+        file_path_[length] = '\0';
+        file_rings_ = ring_capacity;
+        file_.store(static_cast<char*>(mapping), std::memory_order_release);
+        return true;
+#endif
+      }
+
+      auto dump_to_file() noexcept -> bool {
+        char* file = file_.load(std::memory_order_acquire);
+        if (not file)
+          return false;
+
+        char* position = file + sizeof(flight_file_header);
+        std::uint32_t ring_count = 0;
+        for (auto ring = rings(); ring && ring_count != file_rings_; ring = ring->next, ++ring_count) {
+          flight_file_ring header{ring->written.load(std::memory_order_acquire), 0};
+          std::memcpy(position, &header, sizeof(header));
+          std::memcpy(position + sizeof(header), ring->events, sizeof(ring->events));
+          position += ring_size();
+        }
+
+        flight_file_header header{{}, sizeof(flight_event), flight_events_per_ring, ring_count, tick_clock_kind,
+                                  read_ticks()};
+        std::memcpy(header.magic, flight_file_magic, sizeof(header.magic));
+        std::memcpy(file, &header, sizeof(header));
+        return true;
+      }
+
+      auto file_path() const noexcept -> const char* {
+        return file_.load(std::memory_order_acquire) ? file_path_ : nullptr;
+      }
+
+    private:
+      flight_registry() = default;
+
+      struct ring_owner {
+        flight_ring* ring;
+
+        ~ring_owner() {
+          if (ring)
+            ring->owned.store(false, std::memory_order_release);
+        }
+      };
+
+      static constexpr auto ring_size() noexcept -> std::size_t {
+        return sizeof(flight_file_ring) + flight_events_per_ring * sizeof(flight_event);
+      }
+
+      static auto dump_on_failure() -> void;
+
+      auto acquire_ring() noexcept -> flight_ring* {
+        auto thread = threads_.fetch_add(1, std::memory_order_relaxed);
+        for (auto ring = rings(); ring; ring = ring->next) {
+          bool owned = false;
+          if (not ring->owned.load(std::memory_order_relaxed) &&
+              ring->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+            ring->thread = thread;
+            return ring;
+          }
+        }
+
+        auto ring = new(std::nothrow) flight_ring;
+        if (not ring)
+          return nullptr;
+        ring->thread = thread;
+        ring->next = rings_.load(std::memory_order_relaxed);
+        while (not rings_.compare_exchange_weak(ring->next, ring, std::memory_order_release,
+                                                std::memory_order_relaxed));
+
+        failure_hook expected = nullptr;
+        failure_hook_slot().compare_exchange_strong(expected, &flight_registry::dump_on_failure);
+        return ring;
+      }
+
+      std::atomic<flight_ring*> rings_{nullptr};
+      std::atomic<std::uint32_t> threads_{0};
+      std::atomic<char*> file_{nullptr};
+      std::size_t file_rings_ = 0;
+      char file_path_[256] = {};
+    };
+
+  }
+
+  // Per thread rings of the last MILLI_FLIGHT_RECORDER_EVENTS events recorded with MILLI_TRACE. Recording is a few
+  // plain stores into memory only the recording thread writes to: no lock, no read-modify-write, no allocation after
+  // the first event of a thread.
+  //
+  // Once any thread has recorded an event, a failing strong_assert, and with it not_empty_h and every other hard error
+  // handler, dumps all rings before terminating: into the file given to map_file() if there is one, as text to stderr
+  // otherwise. Binary dumps are turned into the same text by decode(), e.g. with the milli_flight_decode tool.
+  class flight_recorder {
+  public:
+    static constexpr std::size_t events_per_thread = detail::flight_events_per_ring;
+
+    template<std::size_t N, typename... Args>
+    static auto trace(const char (&name)[N], Args... arguments) noexcept -> void {
+      static_assert(sizeof...(Args) <= 3, "flight recorder events carry at most three arguments");
+
+      detail::flight_ring* ring = detail::flight_registry::local_ring();
+      if (MILLI_UNLIKELY(not ring))
+        return;
+
+      const std::uint64_t values[] = {detail::flight_argument(arguments)..., 0};
+      constexpr std::size_t length = N - 1 < sizeof(flight_event::name) - 1 ? N - 1 : sizeof(flight_event::name) - 1;
+
+      auto index = ring->written.load(std::memory_order_relaxed);
+      flight_event& event = ring->events[index & (events_per_thread - 1)];
+      event.timestamp = detail::read_ticks();
+      for (std::size_t argument = 0; argument != 3; ++argument)
+        event.arguments[argument] = argument < sizeof...(Args) ? values[argument] : 0;
+      event.thread = ring->thread;
+      event.argument_count = sizeof...(Args);
+      event.signed_arguments = detail::flight_signed_mask(0, arguments...);
+      std::memcpy(event.name, name, length);
+      event.name[length] = '\0';
+      ring->written.store(index + 1, std::memory_order_release);
+    }
+
+    // Writes the events of every thread as text to descriptor, oldest first within a thread, one line per event:
+    //   [thread 3] -1520 ticks name 1 -2 3
+    // The time is relative to the dump. Async-signal-safe; events written during the dump may come out torn.
+    static auto dump(int descriptor) noexcept -> void {
+      detail::flight_text output(descriptor);
+      auto now = detail::read_ticks();
+      output.text("milli flight recorder, times relative to the dump:\n");
+      for (auto ring = detail::flight_registry::instance().rings(); ring; ring = ring->next)
+        write_ring(output, ring->events, ring->written.load(std::memory_order_acquire), events_per_thread, now,
+                   detail::tick_clock_kind);
+    }
+
+    // Maps path, created or truncated, large enough for the rings of max_threads threads; failures dump there from
+    // then on, and the file outlives the process even if it is killed right after. Call it once, at start up.
+    static auto map_file(const char* path, std::size_t max_threads = 64) noexcept -> bool {
+      return detail::flight_registry::instance().map_file(path, max_threads);
+    }
+
+    // Copies the rings into the mapped file. Async-signal-safe. False if map_file() did not succeed.
+    static auto dump_to_file() noexcept -> bool {
+      return detail::flight_registry::instance().dump_to_file();
+    }
+
+    // Writes the text dump of a file produced by dump_to_file() to descriptor. False, and nothing written, if data is
+    // not such a dump.
+    static auto decode(const void* data, std::size_t size, int descriptor) noexcept -> bool {
+      const char* bytes = static_cast<const char*>(data);
+      detail::flight_file_header header;
+      if (size < sizeof(header))
+        return false;
+      std::memcpy(&header, bytes, sizeof(header));
+
+      std::size_t ring_size = sizeof(detail::flight_file_ring) + header.events_per_ring * sizeof(flight_event);
+      if (std::memcmp(header.magic, detail::flight_file_magic, sizeof(header.magic)) != 0 ||
+          header.event_size != sizeof(flight_event) || header.events_per_ring == 0 ||
+          (header.events_per_ring & (header.events_per_ring - 1)) != 0 ||
+          (size - sizeof(header)) / ring_size < header.ring_count)
+        return false;
+
+      detail::flight_text output(descriptor);
+      output.text("milli flight recorder, times relative to the dump:\n");
+      const char* ring = bytes + sizeof(header);
+      for (std::uint32_t index = 0; index != header.ring_count; ++index, ring += ring_size) {
+        detail::flight_file_ring ring_header;
+        std::memcpy(&ring_header, ring, sizeof(ring_header));
+        write_ring(output, ring + sizeof(ring_header), ring_header.written, header.events_per_ring, header.dump_time,
+                   header.clock);
+      }
+      return true;
+    }
+
+  private:
+    static auto write_ring(detail::flight_text& output, const void* events, std::uint64_t written, std::size_t capacity,
+                           std::uint64_t dump_time, std::uint32_t clock) noexcept -> void {
+      auto first = written > capacity ? written - capacity : 0;
+      for (auto index = first; index != written; ++index) {
+        flight_event event;
+        std::memcpy(&event, static_cast<const char*>(events) + (index & (capacity - 1)) * sizeof(flight_event),
+                    sizeof(event));
+        output.event(event, dump_time, clock);
+      }
+    }
+  };
+
+  namespace detail {
+
+    inline auto flight_registry::dump_on_failure() -> void {
+      if (flight_recorder::dump_to_file()) {
+        flight_text output(2);
+        output.text("milli flight recorder dumped to ").text(instance().file_path()).put('\n');
+      } else {
+        flight_recorder::dump(2);
+      }
+    }
+
+  }
+
+}
+
+#endif //MILLI_LIBRARY_FLIGHT_RECORDER_HPP
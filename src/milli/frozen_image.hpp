@@ -0,0 +1,810 @@
+/*
+frozen_image.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_FROZEN_IMAGE_HPP
+#define MILLI_LIBRARY_FROZEN_IMAGE_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only containers of trivially copyable elements stored in a file that is mapped instead of parsed:
+//
+//   milli::frozen_image<milli::frozen_map<std::uint64_t, price>>::write("prices.img", prices);
+//   auto image = milli::frozen_image<milli::frozen_map<std::uint64_t, price>>::open("prices.img");
+//   const price* found = image->find(id);
+//
+// The image is a header followed by the elements, addressed by offsets from the start of the file, so it is valid
+// wherever it is mapped. Processes that open the same file share its pages in the page cache instead of each building
+// a private copy. Elements must not contain pointers: they would point into the address space of the writer.
+
+namespace milli {
+
+  // What open() checks besides the header: the checksum of all elements, which reads every page of the image once, or
+  // nothing more, so that pages are only read when lookups touch them.
+  enum class frozen_check {
+    checksum,
+    header
+  };
+
+  class frozen_image_error : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
+
+  // Array of elements in an image, in the order they were written.
+  template<typename T>
+  class frozen_vector {
+    static_assert(std::is_trivially_copyable<T>::value, "elements of frozen containers must be trivially copyable");
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_iterator = const T*;
+    using iterator = const_iterator;
+
+    frozen_vector() noexcept = default;
+
+    frozen_vector(const T* data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+    auto begin() const noexcept -> const_iterator {
+      return data_;
+    }
+
+    auto end() const noexcept -> const_iterator {
+      return data_ + size_;
+    }
+
+    auto data() const noexcept -> const T* {
+      return data_;
+    }
+
+    auto size() const noexcept -> std::size_t {
+      return size_;
+    }
+
+    auto empty() const noexcept -> bool {
+      return size_ == 0;
+    }
+
+    auto operator[](std::size_t index) const noexcept -> const T& {
+      return data_[index];
+    }
+
+  private:
+    const T* data_ = nullptr;
+    std::size_t size_ = 0;
+  };
+
+  // Sorted array of unique keys, searched with a binary search.
+  //
+  // Compare is default constructed for every lookup, so it has to be a stateless ordering. The image does not record
+  // it: open it with the Compare it was written with, or bump the layout_version when the ordering changes.
+  template<typename Key, typename Compare = std::less<Key>>
+  class frozen_set {
+    static_assert(std::is_default_constructible<Compare>::value, "frozen containers default construct Compare");
+
+  public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+    using const_iterator = const Key*;
+    using iterator = const_iterator;
+
+    frozen_set() noexcept = default;
+
+    // keys have to be sorted by Compare and unique.
+    frozen_set(const Key* keys, std::size_t size) noexcept : keys_(keys, size) {}
+
+    auto begin() const noexcept -> const_iterator {
+      return keys_.begin();
+    }
+
+    auto end() const noexcept -> const_iterator {
+      return keys_.end();
+    }
+
+    auto size() const noexcept -> std::size_t {
+      return keys_.size();
+    }
+
+    auto empty() const noexcept -> bool {
+      return keys_.empty();
+    }
+
+    auto lower_bound(const Key& key) const -> const_iterator {
+      return std::lower_bound(begin(), end(), key, Compare());
+    }
+
+    auto find(const Key& key) const -> const_iterator {
+      auto position = lower_bound(key);
+      return position != end() && not Compare()(key, *position) ? position : end();
+    }
+
+    auto contains(const Key& key) const -> bool {
+      return find(key) != end();
+    }
+
+    auto count(const Key& key) const -> std::size_t {
+      return contains(key) ? 1 : 0;
+    }
+
+  private:
+    frozen_vector<Key> keys_;
+  };
+
+  // Sorted array of unique keys and the array of their values, kept apart so that the search only reads keys. Compare
+  // is required to be what it is for frozen_set.
+  template<typename Key, typename T, typename Compare = std::less<Key>>
+  class frozen_map {
+  public:
+    using key_type = Key;
+    using mapped_type = T;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+
+    frozen_map() noexcept = default;
+
+    // keys have to be sorted by Compare and unique, values[i] belongs to keys[i].
+    frozen_map(const Key* keys, const T* values, std::size_t size) noexcept
+        : keys_(keys, size), values_(values, size) {}
+
+    auto keys() const noexcept -> const frozen_set<Key, Compare>& {
+      return keys_;
+    }
+
+    auto values() const noexcept -> const frozen_vector<T>& {
+      return values_;
+    }
+
+    auto size() const noexcept -> std::size_t {
+      return keys_.size();
+    }
+
+    auto empty() const noexcept -> bool {
+      return keys_.empty();
+    }
+
+    // The value stored for key, nullptr if there is none.
+    auto find(const Key& key) const -> const T* {
+      auto position = keys_.find(key);
+      return position != keys_.end() ? values_.data() + (position - keys_.begin()) : nullptr;
+    }
+
+    auto at(const Key& key) const -> const T& {
+      auto value = find(key);
+      if (not value)
+        throw std::out_of_range("milli::frozen_map::at: no such key");
+      return *value;
+    }
+
+    auto contains(const Key& key) const -> bool {
+      return keys_.contains(key);
+    }
+
+    auto count(const Key& key) const -> std::size_t {
+      return keys_.count(key);
+    }
+
+  private:
+    frozen_set<Key, Compare> keys_;
+    frozen_vector<T> values_;
+  };
+
+  namespace detail {
+
+    // Layout of an image, all offsets from its first byte:
+    //
+    //   frozen_header
+    //   first array   count elements of first_size bytes at first_offset, 64 byte aligned
+    //   second array  count elements of second_size bytes at second_offset, 64 byte aligned, empty for sets and vectors
+    //
+    // Gaps are zero. The checksum covers everything after the header up to image_size.
+    struct frozen_header {
+      char magic[8];
+      std::uint32_t format_version;
+      std::uint32_t kind;
+      std::uint32_t byte_order;
+      std::uint32_t header_size;
+      std::uint64_t layout_version;
+      std::uint32_t first_size;
+      std::uint32_t first_alignment;
+      std::uint32_t second_size;
+      std::uint32_t second_alignment;
+      std::uint64_t count;
+      std::uint64_t first_offset;
+      std::uint64_t second_offset;
+      std::uint64_t image_size;
+      std::uint64_t checksum;
+    };
+
+    constexpr char frozen_magic[8] = {'M', 'I', 'L', 'L', 'I', 'F', 'R', 'Z'};
+    constexpr std::uint32_t frozen_format_version = 1;
+    constexpr std::uint32_t frozen_byte_order = 0x01020304;
+    constexpr std::uint64_t frozen_alignment = 64;
+
+    enum frozen_kind : std::uint32_t {
+      frozen_vector_kind = 1,
+      frozen_set_kind = 2,
+      frozen_map_kind = 3
+    };
+
+    inline auto frozen_align(std::uint64_t offset) noexcept -> std::uint64_t {
+      return (offset + frozen_alignment - 1) / frozen_alignment * frozen_alignment;
+    }
+
+    // 64 bit checksum of a byte stream fed in pieces of any size. Words are read in native byte order, images of the
+    // other order are rejected before their checksum is looked at. A multiply per word keeps it at several GB/s.
+    class frozen_checksum {
+    public:
+      auto update(const void* data, std::size_t size) noexcept -> void {
+        if (size == 0)
+          return;
+        auto bytes = static_cast<const unsigned char*>(data);
+        length_ += size;
+        if (buffered_ != 0) {
+          std::size_t taken = size < 8 - buffered_ ? size : 8 - buffered_;
+          std::memcpy(buffer_ + buffered_, bytes, taken);
+          buffered_ += taken;
+          bytes += taken;
+          size -= taken;
+          if (buffered_ != 8)
+            return;
+          state_ = mix(state_, load(buffer_));
+          buffered_ = 0;
+        }
+        for (; size >= 8; bytes += 8, size -= 8)
+          state_ = mix(state_, load(bytes));
+        std::memcpy(buffer_, bytes, size);
+        buffered_ = size;
+      }
+
+      auto value() const noexcept -> std::uint64_t {
+        auto state = state_;
+        if (buffered_ != 0) {
+          unsigned char last[8] = {};
+          std::memcpy(last, buffer_, buffered_);
+          state = mix(state, load(last));
+        }
+        state ^= length_;
+        state ^= state >> 33;
+        state *= 0xff51afd7ed558ccdull;
+        return state ^ (state >> 33);
+      }
+
+    private:
+      static auto load(const unsigned char* bytes) noexcept -> std::uint64_t {
+        std::uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        return word;
+      }
+
+      static auto mix(std::uint64_t state, std::uint64_t word) noexcept -> std::uint64_t {
+        return (((state << 23) | (state >> 41)) ^ word) * 0x9e3779b97f4a7c15ull;
+      }
+
+      std::uint64_t state_ = 0;
+      std::uint64_t length_ = 0;
+      unsigned char buffer_[8] = {};
+      std::size_t buffered_ = 0;
+    };
+
+    // Hands everything after the header to sink, gaps included, in the order it is stored.
+    template<typename Sink>
+    auto for_each_frozen_piece(const frozen_header& header, const void* first, const void* second, Sink&& sink)
+    -> void {
+      static const unsigned char zeros[frozen_alignment] = {};
+      std::uint64_t first_end = header.first_offset + header.count * header.first_size;
+      sink(zeros, static_cast<std::size_t>(header.first_offset - header.header_size));
+      sink(first, static_cast<std::size_t>(header.count * header.first_size));
+      sink(zeros, static_cast<std::size_t>(header.second_offset - first_end));
+      sink(second, static_cast<std::size_t>(header.count * header.second_size));
+    }
+
+    [[noreturn]] inline auto throw_frozen_write_error(int error, const std::string& path) -> void {
+      throw std::system_error(error, std::generic_category(), "milli::frozen_image: can not write " + path);
+    }
+
+    // Creates a file next to path under a name of its own, so that concurrent writers of one path each fill their
+    // own file and the last rename wins. temporary receives the name.
+    inline auto create_frozen_temporary(const std::string& path, std::string& temporary) -> std::FILE* {
+#if defined(_WIN32)
+      // _mktemp_s only picks a name that is free now, _O_EXCL fails if another writer took it since.
+      int descriptor = -1;
+      for (int attempt = 0; descriptor < 0 && attempt != 26; ++attempt) {
+        temporary = path + ".XXXXXX";
+        if (::_mktemp_s(&temporary[0], temporary.size() + 1) != 0)
+          break;
+        descriptor = ::_open(temporary.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE);
+        if (descriptor < 0 && errno != EEXIST)
+          break;
+      }
+      std::FILE* file = descriptor < 0 ? nullptr : ::_fdopen(descriptor, "wb");
+      if (not file) {
+        int error = errno;
+        if (descriptor >= 0) {
+          ::_close(descriptor);
+          std::remove(temporary.c_str());
+        }
+        throw_frozen_write_error(error, path);
+      }
+      return file;
+#else
+      temporary = path + ".XXXXXX";
+      int descriptor = ::mkstemp(&temporary[0]);
+      if (descriptor < 0)
+        throw_frozen_write_error(errno, path);
+
+      // mkstemp creates the file readable by its owner only, but images are meant to be mapped by other processes:
+      // the image keeps the mode of the one it replaces, a new one is readable by everyone.
+      struct stat status;
+      ::mode_t mode = ::stat(path.c_str(), &status) == 0 ? status.st_mode & 0777 : 0644;
+      std::FILE* file = ::fchmod(descriptor, mode) == 0 ? ::fdopen(descriptor, "wb") : nullptr;
+      if (not file) {
+        int error = errno;
+        ::close(descriptor);
+        ::unlink(temporary.c_str());
+        throw_frozen_write_error(error, path);
+      }
+      return file;
+#endif
+    }
+
+    inline auto sync_frozen_file(std::FILE* file) -> bool {
+      if (std::fflush(file) != 0)
+        return false;
+#if defined(_WIN32)
+      return ::_commit(::_fileno(file)) == 0;
+#else
+      return ::fsync(::fileno(file)) == 0;
+#endif
+    }
+
+    // Makes the rename durable. Windows can not sync a directory, NTFS journals the rename itself.
+    inline auto sync_frozen_directory(const std::string& path) -> void {
+#ifndef _WIN32
+      auto separator = path.rfind('/');
+      std::string directory = separator == std::string::npos ? "." : separator == 0 ? "/" : path.substr(0, separator);
+      int descriptor = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+      if (descriptor < 0)
+        throw_frozen_write_error(errno, path);
+      int error = ::fsync(descriptor) == 0 ? 0 : errno;
+      ::close(descriptor);
+      if (error != 0)
+        throw_frozen_write_error(error, path);
+#else
+      (void)path;
+#endif
+    }
+
+    // Writes to a temporary file that replaces path once complete: processes that have the old image mapped keep
+    // their pages, truncating it in place would crash them. The file is synced before the rename, so that a crash
+    // can not leave path naming an image whose elements never reached the disk, and the directory after it.
+    inline auto write_frozen_file(const std::string& path, frozen_header header, const void* first,
+                                  const void* second) -> void {
+      std::memcpy(header.magic, frozen_magic, sizeof(frozen_magic));
+      header.format_version = frozen_format_version;
+      header.byte_order = frozen_byte_order;
+      header.header_size = sizeof(frozen_header);
+      header.first_offset = frozen_align(sizeof(frozen_header));
+      header.second_offset = frozen_align(header.first_offset + header.count * header.first_size);
+      header.image_size = header.second_offset + header.count * header.second_size;
+
+      frozen_checksum checksum;
+      for_each_frozen_piece(header, first, second, [&checksum](const void* data, std::size_t size) {
+        checksum.update(data, size);
+      });
+      header.checksum = checksum.value();
+
+      std::string temporary;
+      std::FILE* file = create_frozen_temporary(path, temporary);
+
+      // errno is kept right after the call that failed: a later fclose may overwrite it.
+      int error = 0;
+      bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+      if (not written)
+        error = errno;
+      for_each_frozen_piece(header, first, second, [&written, &error, file](const void* data, std::size_t size) {
+        if (written && size != 0 && std::fwrite(data, 1, size, file) != size) {
+          written = false;
+          error = errno;
+        }
+      });
+      if (written && not sync_frozen_file(file)) {
+        written = false;
+        error = errno;
+      }
+      if (std::fclose(file) != 0 && written) {
+        written = false;
+        error = errno;
+      }
+
+#if defined(_WIN32)
+      if (written)
+        std::remove(path.c_str());
+#endif
+      if (not written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        error = written ? errno : error;
+        std::remove(temporary.c_str());
+        throw_frozen_write_error(error, path);
+      }
+      sync_frozen_directory(path);
+    }
+
+    // Read-only view of a whole file, mapped where the system allows it and read into memory otherwise. Either way
+    // the data starts on a frozen_alignment boundary, as the offsets of the image assume.
+    class frozen_mapping {
+    public:
+      frozen_mapping() noexcept = default;
+
+#if defined(_WIN32)
+      frozen_mapping(std::unique_ptr<unsigned char[]> buffer, const unsigned char* data, std::size_t size) noexcept
+          : data_(data), size_(size), buffer_(std::move(buffer)) {}
+#else
+      frozen_mapping(const unsigned char* data, std::size_t size) noexcept : data_(data), size_(size) {}
+#endif
+
+      frozen_mapping(frozen_mapping&& other) noexcept : data_(other.data_), size_(other.size_) {
+#if defined(_WIN32)
+        buffer_ = std::move(other.buffer_);
+#endif
+        other.data_ = nullptr;
+        other.size_ = 0;
+      }
+
+      auto operator=(frozen_mapping&& other) noexcept -> frozen_mapping& {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#if defined(_WIN32)
+        std::swap(buffer_, other.buffer_);
+#endif
+        return *this;
+      }
+
+      ~frozen_mapping() {
+#ifndef _WIN32
+        if (data_)
+          ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+      }
+
+      auto data() const noexcept -> const unsigned char* {
+        return data_;
+      }
+
+      auto size() const noexcept -> std::size_t {
+        return size_;
+      }
+
+    private:
+      const unsigned char* data_ = nullptr;
+      std::size_t size_ = 0;
+#if defined(_WIN32)
+      std::unique_ptr<unsigned char[]> buffer_;
+#endif
+    };
+
+    [[noreturn]] inline auto throw_frozen_system_error(const std::string& path) -> void {
+      throw std::system_error(errno, std::generic_category(), "milli::frozen_image: can not read " + path);
+    }
+
+    [[noreturn]] inline auto throw_frozen_image_error(const std::string& path, const char* problem) -> void {
+      throw frozen_image_error("milli::frozen_image: " + path + ": " + problem);
+    }
+
+    inline auto map_frozen_file(const std::string& path) -> frozen_mapping {
+#if defined(_WIN32)
+      std::FILE* file = std::fopen(path.c_str(), "rb");
+      if (not file)
+        throw_frozen_system_error(path);
+      std::unique_ptr<std::FILE, int (*)(std::FILE*)> closer(file, &std::fclose);
+      long size = -1;
+      if (std::fseek(file, 0, SEEK_END) == 0)
+        size = std::ftell(file);
+      if (size < 0 || std::fseek(file, 0, SEEK_SET) != 0)
+        throw_frozen_system_error(path);
+      if (static_cast<std::size_t>(size) < sizeof(frozen_header))
+        throw_frozen_image_error(path, "too small to be an image");
+      // new[] only aligns to the fundamental alignment: over-allocate and start the data on the next boundary.
+      std::unique_ptr<unsigned char[]> buffer(new unsigned char[static_cast<std::size_t>(size) + frozen_alignment - 1]);
+      auto address = reinterpret_cast<std::uintptr_t>(buffer.get());
+      auto data = buffer.get() + (frozen_alignment - address % frozen_alignment) % frozen_alignment;
+      if (std::fread(data, 1, static_cast<std::size_t>(size), file) != static_cast<std::size_t>(size))
+        throw_frozen_system_error(path);
+      return frozen_mapping(std::move(buffer), data, static_cast<std::size_t>(size));
+#else
+      int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (descriptor < 0)
+        throw_frozen_system_error(path);
+      struct stat status;
+      if (::fstat(descriptor, &status) != 0) {
+        int error = errno;
+        ::close(descriptor);
+        errno = error;
+        throw_frozen_system_error(path);
+      }
+      auto size = static_cast<std::size_t>(status.st_size);
+      if (size < sizeof(frozen_header)) {
+        ::close(descriptor);
+        throw_frozen_image_error(path, "too small to be an image");
+      }
+      void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+      int error = errno;
+      ::close(descriptor);
+      if (mapping == MAP_FAILED) {
+        errno = error;
+        throw_frozen_system_error(path);
+      }
+      return frozen_mapping(static_cast<const unsigned char*>(mapping), size);
+#endif
+    }
+
+    // Checks the header of an image against the one expected for the container type, and the checksum if asked to.
+    inline auto read_frozen_header(const frozen_mapping& mapping, const frozen_header& expected, frozen_check check,
+                                   const std::string& path) -> frozen_header {
+      frozen_header header;
+      std::memcpy(&header, mapping.data(), sizeof(header));
+
+      if (std::memcmp(header.magic, frozen_magic, sizeof(frozen_magic)) != 0)
+        throw_frozen_image_error(path, "not a frozen image");
+      if (header.format_version != frozen_format_version)
+        throw_frozen_image_error(path, "unsupported format version");
+      if (header.byte_order != frozen_byte_order)
+        throw_frozen_image_error(path, "written with a different byte order");
+      if (header.kind != expected.kind || header.first_size != expected.first_size ||
+          header.first_alignment != expected.first_alignment || header.second_size != expected.second_size ||
+          header.second_alignment != expected.second_alignment)
+        throw_frozen_image_error(path, "holds a different container or element type");
+      if (header.layout_version != expected.layout_version)
+        throw_frozen_image_error(path, "written with a different layout version");
+
+      // Sizes are checked by division, a corrupt count must not overflow into a plausible end.
+      std::uint64_t size = mapping.size();
+      bool valid = header.header_size == sizeof(frozen_header) && header.image_size == size &&
+                   header.first_offset == frozen_align(header.header_size) && header.first_offset <= size &&
+                   (header.first_size == 0 || header.count <= (size - header.first_offset) / header.first_size);
+      if (valid) {
+        std::uint64_t first_end = header.first_offset + header.count * header.first_size;
+        valid = header.second_offset == frozen_align(first_end) && header.second_offset <= size &&
+                (header.second_size == 0 || header.count <= (size - header.second_offset) / header.second_size) &&
+                header.second_offset + header.count * header.second_size == size &&
+                header.count <= static_cast<std::uint64_t>(static_cast<std::size_t>(-1));
+      }
+      if (not valid)
+        throw_frozen_image_error(path, "truncated or corrupt header");
+
+      if (check == frozen_check::checksum) {
+        frozen_checksum checksum;
+        checksum.update(mapping.data() + header.header_size, mapping.size() - header.header_size);
+        if (checksum.value() != header.checksum)
+          throw_frozen_image_error(path, "checksum mismatch");
+      }
+      return header;
+    }
+
+    template<typename Frozen>
+    struct frozen_layout;
+
+    template<typename T>
+    struct frozen_layout<frozen_vector<T>> {
+      static_assert(alignof(T) <= frozen_alignment, "elements of frozen containers can not be over-aligned");
+
+      static auto expected(std::uint64_t layout_version) noexcept -> frozen_header {
+        frozen_header header = {};
+        header.kind = frozen_vector_kind;
+        header.layout_version = layout_version;
+        header.first_size = sizeof(T);
+        header.first_alignment = alignof(T);
+        return header;
+      }
+
+      template<typename Container>
+      static auto write(const std::string& path, const Container& container, std::uint64_t layout_version) -> void {
+        std::vector<T> elements(std::begin(container), std::end(container));
+        frozen_header header = expected(layout_version);
+        header.count = elements.size();
+        write_frozen_file(path, header, elements.data(), nullptr);
+      }
+
+      static auto view(const unsigned char* image, const frozen_header& header) noexcept -> frozen_vector<T> {
+        return frozen_vector<T>(reinterpret_cast<const T*>(image + header.first_offset),
+                                static_cast<std::size_t>(header.count));
+      }
+    };
+
+    template<typename Key, typename Compare>
+    struct frozen_layout<frozen_set<Key, Compare>> {
+      static_assert(std::is_trivially_copyable<Key>::value, "keys of frozen containers must be trivially copyable");
+      static_assert(alignof(Key) <= frozen_alignment, "keys of frozen containers can not be over-aligned");
+
+      static auto expected(std::uint64_t layout_version) noexcept -> frozen_header {
+        frozen_header header = {};
+        header.kind = frozen_set_kind;
+        header.layout_version = layout_version;
+        header.first_size = sizeof(Key);
+        header.first_alignment = alignof(Key);
+        return header;
+      }
+
+      // Sorted and deduplicated like std::set does: of equivalent keys the first one is kept.
+      template<typename Container>
+      static auto write(const std::string& path, const Container& container, std::uint64_t layout_version) -> void {
+        std::vector<Key> keys(std::begin(container), std::end(container));
+        Compare compare;
+        std::stable_sort(keys.begin(), keys.end(), compare);
+        keys.erase(std::unique(keys.begin(), keys.end(), [&compare](const Key& lhs, const Key& rhs) {
+          return not compare(lhs, rhs);
+        }), keys.end());
+
+        frozen_header header = expected(layout_version);
+        header.count = keys.size();
+        write_frozen_file(path, header, keys.data(), nullptr);
+      }
+
+      static auto view(const unsigned char* image, const frozen_header& header) noexcept
+      -> frozen_set<Key, Compare> {
+        return frozen_set<Key, Compare>(reinterpret_cast<const Key*>(image + header.first_offset),
+                                        static_cast<std::size_t>(header.count));
+      }
+    };
+
+    template<typename Key, typename T, typename Compare>
+    struct frozen_layout<frozen_map<Key, T, Compare>> {
+      static_assert(std::is_trivially_copyable<Key>::value, "keys of frozen containers must be trivially copyable");
+      static_assert(std::is_trivially_copyable<T>::value, "values of frozen containers must be trivially copyable");
+      static_assert(alignof(Key) <= frozen_alignment, "keys of frozen containers can not be over-aligned");
+      static_assert(alignof(T) <= frozen_alignment, "values of frozen containers can not be over-aligned");
+
+      static auto expected(std::uint64_t layout_version) noexcept -> frozen_header {
+        frozen_header header = {};
+        header.kind = frozen_map_kind;
+        header.layout_version = layout_version;
+        header.first_size = sizeof(Key);
+        header.first_alignment = alignof(Key);
+        header.second_size = sizeof(T);
+        header.second_alignment = alignof(T);
+        return header;
+      }
+
+      // Takes any range of pairs, a std::map as well as a vector of std::pair in any order. Of entries with
+      // equivalent keys the first one is kept, as std::map does.
+      template<typename Container>
+      static auto write(const std::string& path, const Container& container, std::uint64_t layout_version) -> void {
+        std::vector<std::pair<Key, T>> entries(std::begin(container), std::end(container));
+        Compare compare;
+        auto key_less = [&compare](const std::pair<Key, T>& lhs, const std::pair<Key, T>& rhs) {
+          return compare(lhs.first, rhs.first);
+        };
+        std::stable_sort(entries.begin(), entries.end(), key_less);
+        entries.erase(std::unique(entries.begin(), entries.end(), [&key_less](const std::pair<Key, T>& lhs,
+                                                                              const std::pair<Key, T>& rhs) {
+          return not key_less(lhs, rhs);
+        }), entries.end());
+
+        std::vector<Key> keys;
+        std::vector<T> values;
+        keys.reserve(entries.size());
+        values.reserve(entries.size());
+        for (auto& entry : entries) {
+          keys.push_back(entry.first);
+          values.push_back(entry.second);
+        }
+
+        frozen_header header = expected(layout_version);
+        header.count = keys.size();
+        write_frozen_file(path, header, keys.data(), values.data());
+      }
+
+      static auto view(const unsigned char* image, const frozen_header& header) noexcept
+      -> frozen_map<Key, T, Compare> {
+        return frozen_map<Key, T, Compare>(reinterpret_cast<const Key*>(image + header.first_offset),
+                                           reinterpret_cast<const T*>(image + header.second_offset),
+                                           static_cast<std::size_t>(header.count));
+      }
+    };
+
+  }
+
+  // Owner of a mapped image of a frozen_vector, frozen_set or frozen_map. Frozen is the container type it holds, the
+  // file records it and open() refuses images of another container or element type.
+  //
+  // layout_version is a number of the caller's choice written into the image and required to match on open(). Bump it
+  // when the layout of the element types changes without changing their size, which open() can not detect.
+  template<typename Frozen>
+  class frozen_image {
+    using layout = detail::frozen_layout<Frozen>;
+
+  public:
+    // Writes the elements of container, any range of elements, keys or key value pairs, to path. path is replaced
+    // atomically, images already opened from it stay valid, and of concurrent writers the last one to finish wins.
+    // Throws std::system_error if the file can not be written.
+    template<typename Container>
+    static auto write(const std::string& path, const Container& container, std::uint64_t layout_version = 0)
+    -> void {
+      layout::write(path, container, layout_version);
+    }
+
+    // Maps the image at path read-only. Throws std::system_error if the file can not be read and frozen_image_error
+    // if it is not a valid image of Frozen.
+    static auto open(const std::string& path, frozen_check check = frozen_check::checksum,
+                     std::uint64_t layout_version = 0) -> frozen_image {
+      detail::frozen_mapping mapping = detail::map_frozen_file(path);
+      auto header = detail::read_frozen_header(mapping, layout::expected(layout_version), check, path);
+      Frozen frozen = layout::view(mapping.data(), header);
+      return frozen_image(std::move(mapping), frozen);
+    }
+
+    frozen_image(frozen_image&& other) noexcept : mapping_(std::move(other.mapping_)), frozen_(other.frozen_) {
+      other.frozen_ = Frozen();
+    }
+
+    auto operator=(frozen_image&& other) noexcept -> frozen_image& {
+      mapping_ = std::move(other.mapping_);
+      std::swap(frozen_, other.frozen_);
+      return *this;
+    }
+
+    auto get() const noexcept -> const Frozen& {
+      return frozen_;
+    }
+
+    auto operator*() const noexcept -> const Frozen& {
+      return frozen_;
+    }
+
+    auto operator->() const noexcept -> const Frozen* {
+      return &frozen_;
+    }
+
+    // Bytes of the whole file, header included.
+    auto image_size() const noexcept -> std::size_t {
+      return mapping_.size();
+    }
+
+  private:
+    frozen_image(detail::frozen_mapping&& mapping, const Frozen& frozen) noexcept
+        : mapping_(std::move(mapping)), frozen_(frozen) {}
+
+    detail::frozen_mapping mapping_;
+    Frozen frozen_;
+  };
+
+}
+
+#endif //MILLI_LIBRARY_FROZEN_IMAGE_HPP
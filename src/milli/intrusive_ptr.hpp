@@ -0,0 +1,166 @@
+/*
+intrusive_ptr.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_INTRUSIVE_PTR_HPP
+#define MILLI_LIBRARY_INTRUSIVE_PTR_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace milli {
+
+  // Base that gives Derived a single-threaded reference count for intrusive_ptr. A copied object starts with a count
+  // of its own, the count is never copied along with the value.
+  template<typename Derived>
+  class intrusive_ref_counter {
+  public:
+    auto use_count() const noexcept -> std::size_t {
+      return count_;
+    }
+
+  protected:
+    intrusive_ref_counter() noexcept : count_(0) {}
+
+    intrusive_ref_counter(const intrusive_ref_counter&) noexcept : count_(0) {}
+
+    auto operator=(const intrusive_ref_counter&) noexcept -> intrusive_ref_counter& {
+      return *this;
+    }
+
+    ~intrusive_ref_counter() = default;
+
+  private:
+    friend auto intrusive_ptr_add_ref(const intrusive_ref_counter* counter) noexcept -> void {
+      ++counter->count_;
+    }
+
+    friend auto intrusive_ptr_release(const intrusive_ref_counter* counter) noexcept -> void {
+      if (--counter->count_ == 0)
+        delete static_cast<const Derived*>(counter);
+    }
+
+    mutable std::size_t count_;
+  };
+
+  // Pointer to an object that counts its own references: the pointer is one word wide and never allocates. The count
+  // is managed through intrusive_ptr_add_ref(T*) and intrusive_ptr_release(T*), found by argument dependent lookup;
+  // intrusive_ref_counter provides both. Neither may throw.
+  template<typename T>
+  class intrusive_ptr {
+  public:
+    using element_type = T;
+
+    constexpr intrusive_ptr() noexcept : value_(nullptr) {}
+
+    constexpr intrusive_ptr(std::nullptr_t) noexcept : value_(nullptr) {}
+
+    // Takes a reference to value. With add_ref == false an already counted reference is adopted instead.
+    explicit intrusive_ptr(T* value, bool add_ref = true) noexcept : value_(value) {
+      if (value_ && add_ref)
+        intrusive_ptr_add_ref(value_);
+    }
+
+    intrusive_ptr(const intrusive_ptr& rhs) noexcept : intrusive_ptr(rhs.value_) {}
+
+    intrusive_ptr(intrusive_ptr&& rhs) noexcept : value_(rhs.value_) {
+      rhs.value_ = nullptr;
+    }
+
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    intrusive_ptr(const intrusive_ptr<U>& rhs) noexcept : intrusive_ptr(rhs.get()) {}
+
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    intrusive_ptr(intrusive_ptr<U>&& rhs) noexcept : value_(rhs.detach()) {}
+
+    ~intrusive_ptr() {
+      if (value_)
+        intrusive_ptr_release(value_);
+    }
+
+    auto operator=(intrusive_ptr rhs) noexcept -> intrusive_ptr& {
+      swap(rhs);
+      return *this;
+    }
+
+    auto operator*() const noexcept -> T& {
+      return *value_;
+    }
+
+    auto operator->() const noexcept -> T* {
+      return value_;
+    }
+
+    auto get() const noexcept -> T* {
+      return value_;
+    }
+
+    explicit operator bool() const noexcept {
+      return value_ != nullptr;
+    }
+
+    // Gives up the reference without releasing it.
+    auto detach() noexcept -> T* {
+      T* value = value_;
+      value_ = nullptr;
+      return value;
+    }
+
+    auto reset() noexcept -> void {
+      intrusive_ptr().swap(*this);
+    }
+
+    auto swap(intrusive_ptr& rhs) noexcept -> void {
+      std::swap(value_, rhs.value_);
+    }
+
+  private:
+    T* value_;
+  };
+
+  template<typename T, typename... Args>
+  auto make_intrusive(Args&&... args) -> intrusive_ptr<T> {
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+  }
+
+  template<typename T, typename U>
+  auto operator==(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept -> bool {
+    return lhs.get() == rhs.get();
+  }
+
+  template<typename T, typename U>
+  auto operator!=(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept -> bool {
+    return lhs.get() != rhs.get();
+  }
+
+  template<typename T>
+  auto operator==(const intrusive_ptr<T>& lhs, std::nullptr_t) noexcept -> bool {
+    return not lhs;
+  }
+
+  template<typename T>
+  auto operator!=(const intrusive_ptr<T>& lhs, std::nullptr_t) noexcept -> bool {
+    return static_cast<bool>(lhs);
+  }
+
+  template<typename T>
+  auto swap(intrusive_ptr<T>& lhs, intrusive_ptr<T>& rhs) noexcept -> void {
+    lhs.swap(rhs);
+  }
+
+}
+
+#endif //MILLI_LIBRARY_INTRUSIVE_PTR_HPP
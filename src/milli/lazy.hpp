@@ -0,0 +1,166 @@
+/*
+lazy.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_LAZY_HPP
+#define MILLI_LIBRARY_LAZY_HPP
+
+#include <milli/attributes.hpp>
+#include <milli/optional.hpp>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace milli {
+
+  namespace detail {
+
+    template<typename T>
+    struct value_initializer {
+      auto operator()() const -> T {
+        return T();
+      }
+    };
+
+  }
+
+  // Value of type T made by calling Init() the first time it is read, for objects shared by all threads, e.g. globals
+  // and statics. After initialization a read is one acquire load, a plain load on x86 and ARMv8, and a predicted
+  // branch; there is no guard variable and no call as with function local statics or std::call_once. The compiler does
+  // not move atomic loads out of loops, keep the reference get() returns when reading it in a loop.
+  //
+  // The constructors are constexpr when Init's are, so namespace scope lazy objects are constant initialized and may
+  // be read during the dynamic initialization of other globals. If Init throws, the exception propagates and the next
+  // read tries again. T has to be move constructible from the result of Init.
+  template<typename T, typename Init = detail::value_initializer<T>>
+  class lazy {
+  public:
+    using value_type = T;
+
+    constexpr lazy() noexcept(std::is_nothrow_default_constructible<Init>::value) = default;
+
+    constexpr explicit lazy(Init init) noexcept(std::is_nothrow_move_constructible<Init>::value)
+        : init_(std::move(init)) {}
+
+    lazy(const lazy&) = delete;
+    auto operator=(const lazy&) -> lazy& = delete;
+
+    auto get() const -> T& {
+      if (MILLI_LIKELY(state_.load(std::memory_order_acquire) == ready))
+        return *value_;
+      return initialize();
+    }
+
+    auto operator*() const -> T& {
+      return get();
+    }
+
+    auto operator->() const -> T* {
+      return &get();
+    }
+
+    auto initialized() const noexcept -> bool {
+      return state_.load(std::memory_order_acquire) == ready;
+    }
+
+    // Destroys the value, the next read initializes it again. For tests: no other thread may read meanwhile.
+    auto reset() noexcept -> void {
+      if (state_.load(std::memory_order_relaxed) == ready)
+        value_.reset();
+      state_.store(empty, std::memory_order_release);
+    }
+
+  private:
+    enum : unsigned char { empty, initializing, ready };
+
+    // One thread runs Init, the others yield until it is done; initialization is rare enough not to need a futex.
+    MILLI_NOINLINE auto initialize() const -> T& {
+      for (;;) {
+        unsigned char expected = empty;
+        if (state_.compare_exchange_strong(expected, initializing, std::memory_order_acquire)) {
+          try {
+            value_.emplace(init_());
+          } catch (...) {
+            state_.store(empty, std::memory_order_release);
+            throw;
+          }
+          state_.store(ready, std::memory_order_release);
+          return *value_;
+        }
+        if (expected == ready)
+          return *value_;
+        std::this_thread::yield();
+      }
+    }
+
+    mutable std::atomic<unsigned char> state_{empty};
+    mutable detail::optional<T> value_;
+    mutable Init init_{};
+  };
+
+  // Like lazy, without synchronization, for thread_local variables and objects used by one thread only. A read is a
+  // load and a branch on an ordinary bool, which the compiler may move out of loops. Init must not read the object
+  // it initializes.
+  template<typename T, typename Init = detail::value_initializer<T>>
+  class thread_local_lazy {
+  public:
+    using value_type = T;
+
+    constexpr thread_local_lazy() noexcept(std::is_nothrow_default_constructible<Init>::value) = default;
+
+    constexpr explicit thread_local_lazy(Init init) noexcept(std::is_nothrow_move_constructible<Init>::value)
+        : init_(std::move(init)) {}
+
+    thread_local_lazy(const thread_local_lazy&) = delete;
+    auto operator=(const thread_local_lazy&) -> thread_local_lazy& = delete;
+
+    auto get() const -> T& {
+      if (MILLI_LIKELY(static_cast<bool>(value_)))
+        return *value_;
+      return initialize();
+    }
+
+    auto operator*() const -> T& {
+      return get();
+    }
+
+    auto operator->() const -> T* {
+      return &get();
+    }
+
+    auto initialized() const noexcept -> bool {
+      return static_cast<bool>(value_);
+    }
+
+    // Destroys the value, the next read initializes it again.
+    auto reset() noexcept -> void {
+      if (value_)
+        value_.reset();
+    }
+
+  private:
+    MILLI_NOINLINE auto initialize() const -> T& {
+      value_.emplace(init_());
+      return *value_;
+    }
+
+    mutable detail::optional<T> value_;
+    mutable Init init_{};
+  };
+
+}
+
+#endif //MILLI_LIBRARY_LAZY_HPP
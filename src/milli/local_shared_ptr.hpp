@@ -0,0 +1,183 @@
+/*
+local_shared_ptr.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_LOCAL_SHARED_PTR_HPP
+#define MILLI_LIBRARY_LOCAL_SHARED_PTR_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace milli {
+
+  namespace detail {
+
+    // Reference count of one object. The object lives in the same allocation, see local_block.
+    struct local_block_base {
+      std::size_t count;
+      void (*destroy)(local_block_base*);
+    };
+
+    template<typename T>
+    struct local_block : local_block_base {
+      template<typename... Args>
+      explicit local_block(Args&&... args)
+          : local_block_base{1, &local_block::destroy_block}, value(std::forward<Args>(args)...) {}
+
+      static auto destroy_block(local_block_base* block) -> void {
+        delete static_cast<local_block*>(block);
+      }
+
+      T value;
+    };
+  }
+
+  template<typename T>
+  class local_shared_ptr;
+
+  template<typename T, typename... Args>
+  auto make_local_shared(Args&&... args) -> local_shared_ptr<T>;
+
+  // Shared ownership for objects that never leave one thread. The count is a plain integer kept in the same allocation
+  // as the object, so make_local_shared allocates once and copies cost an ordinary increment instead of an atomic one.
+  // Copies of one local_shared_ptr must not be used from different threads concurrently.
+  template<typename T>
+  class local_shared_ptr {
+  public:
+    using element_type = T;
+
+    constexpr local_shared_ptr() noexcept : value_(nullptr), block_(nullptr) {}
+
+    constexpr local_shared_ptr(std::nullptr_t) noexcept : value_(nullptr), block_(nullptr) {}
+
+    local_shared_ptr(const local_shared_ptr& rhs) noexcept : value_(rhs.value_), block_(rhs.block_) {
+      acquire();
+    }
+
+    local_shared_ptr(local_shared_ptr&& rhs) noexcept : value_(rhs.value_), block_(rhs.block_) {
+      rhs.value_ = nullptr;
+      rhs.block_ = nullptr;
+    }
+
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    local_shared_ptr(const local_shared_ptr<U>& rhs) noexcept : value_(rhs.value_), block_(rhs.block_) {
+      acquire();
+    }
+
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    local_shared_ptr(local_shared_ptr<U>&& rhs) noexcept : value_(rhs.value_), block_(rhs.block_) {
+      rhs.value_ = nullptr;
+      rhs.block_ = nullptr;
+    }
+
+    ~local_shared_ptr() {
+      release();
+    }
+
+    auto operator=(local_shared_ptr rhs) noexcept -> local_shared_ptr& {
+      swap(rhs);
+      return *this;
+    }
+
+    auto operator*() const noexcept -> T& {
+      return *value_;
+    }
+
+    auto operator->() const noexcept -> T* {
+      return value_;
+    }
+
+    auto get() const noexcept -> T* {
+      return value_;
+    }
+
+    explicit operator bool() const noexcept {
+      return value_ != nullptr;
+    }
+
+    auto use_count() const noexcept -> std::size_t {
+      return block_ ? block_->count : 0;
+    }
+
+    auto reset() noexcept -> void {
+      release();
+      value_ = nullptr;
+      block_ = nullptr;
+    }
+
+    auto swap(local_shared_ptr& rhs) noexcept -> void {
+      std::swap(value_, rhs.value_);
+      std::swap(block_, rhs.block_);
+    }
+
+  private:
+    template<typename U>
+    friend class local_shared_ptr;
+
+    template<typename U, typename... Args>
+    friend auto make_local_shared(Args&&... args) -> local_shared_ptr<U>;
+
+    local_shared_ptr(T* value, detail::local_block_base* block) noexcept : value_(value), block_(block) {}
+
+    auto acquire() noexcept -> void {
+      if (block_)
+        ++block_->count;
+    }
+
+    auto release() noexcept -> void {
+      if (block_ && --block_->count == 0)
+        block_->destroy(block_);
+    }
+
+    T* value_;
+    detail::local_block_base* block_;
+  };
+
+  // Allocates the object together with its count, like std::make_shared.
+  template<typename T, typename... Args>
+  auto make_local_shared(Args&&... args) -> local_shared_ptr<T> {
+    auto block = new detail::local_block<T>(std::forward<Args>(args)...);
+    return local_shared_ptr<T>(&block->value, block);
+  }
+
+  template<typename T, typename U>
+  auto operator==(const local_shared_ptr<T>& lhs, const local_shared_ptr<U>& rhs) noexcept -> bool {
+    return lhs.get() == rhs.get();
+  }
+
+  template<typename T, typename U>
+  auto operator!=(const local_shared_ptr<T>& lhs, const local_shared_ptr<U>& rhs) noexcept -> bool {
+    return lhs.get() != rhs.get();
+  }
+
+  template<typename T>
+  auto operator==(const local_shared_ptr<T>& lhs, std::nullptr_t) noexcept -> bool {
+    return not lhs;
+  }
+
+  template<typename T>
+  auto operator!=(const local_shared_ptr<T>& lhs, std::nullptr_t) noexcept -> bool {
+    return static_cast<bool>(lhs);
+  }
+
+  template<typename T>
+  auto swap(local_shared_ptr<T>& lhs, local_shared_ptr<T>& rhs) noexcept -> void {
+    lhs.swap(rhs);
+  }
+
+}
+
+#endif //MILLI_LIBRARY_LOCAL_SHARED_PTR_HPP
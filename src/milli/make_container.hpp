@@ -18,28 +18,41 @@ make_container.hpp: This file is part of the Milli Library.
 #ifndef MILLI_MOVE_INITIALIZER_LIST_HPP
 #define MILLI_MOVE_INITIALIZER_LIST_HPP
 
+#include <array>
+#include <cstddef>
 #include <functional>
 #include <iterator>
 #include <initializer_list>
+#include <memory>
 #include <type_traits>
 
 namespace milli{
 
   namespace detail{
 
+    // All the traits below are instantiated with constant depth, no matter how many arguments make_container
+    // receives. Generated tables with hundreds of elements would otherwise hit the template depth limit.
+
+#ifdef __cpp_fold_expressions
+    template <typename T1, typename... Ttail>
+    struct all_same_as : std::integral_constant<bool, (std::is_same<T1, Ttail>::value && ...)>{};
+#else
+    template <bool...>
+    struct bool_pack{};
+
+    template <typename T1, typename... Ttail>
+    struct all_same_as : std::is_same<bool_pack<true, std::is_same<T1, Ttail>::value...>,
+                                      bool_pack<std::is_same<T1, Ttail>::value..., true>>{};
+#endif
+
     template <typename... T>
     struct is_same{
       static constexpr bool value = true;
     };
 
-    template <typename T1, typename T2, typename... Ttail>
-    struct is_same<T1, T2, Ttail...>{
-      static constexpr bool value = is_same<T1, T2>::value && is_same<T2, Ttail...>::value;
-    };
-
-    template <typename T1, typename T2>
-    struct is_same<T1, T2>{
-      static constexpr bool value = std::is_same<T1, T2>::value;
+    template <typename T1, typename... Ttail>
+    struct is_same<T1, Ttail...>{
+      static constexpr bool value = all_same_as<T1, Ttail...>::value;
     };
 
     template <typename T1, typename... Ttail>
@@ -47,32 +60,100 @@ namespace milli{
       using type = T1;
     };
 
-  }
-
-
-  template <typename T, typename... Args>
-  auto make_container(Args&&... args) -> typename std::enable_if<not std::is_lvalue_reference<typename detail::first_of_variadic<Args...>::type>::value, T>::type{
-    using value_type = typename T::value_type;
-    using initializer_type = typename detail::first_of_variadic<Args...>::type;
-    using value_ref = std::reference_wrapper<initializer_type>;
+    // Iterator over an array of pointers that moves from the objects they point to. std::move_iterator over
+    // reference wrappers would not do: it yields an rvalue wrapper, which still converts to an lvalue reference, and
+    // the elements would be copied.
+    template <typename T>
+    class moving_pointee_iterator{
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = T*;
+      using reference = T&&;
+
+      explicit moving_pointee_iterator(T* const* position) noexcept : position_(position){}
+
+      auto operator*() const noexcept -> T&&{
+        return std::move(**position_);
+      }
+
+      auto operator->() const noexcept -> T*{
+        return *position_;
+      }
+
+      auto operator++() noexcept -> moving_pointee_iterator&{
+        ++position_;
+        return *this;
+      }
+
+      auto operator++(int) noexcept -> moving_pointee_iterator{
+        moving_pointee_iterator result = *this;
+        ++position_;
+        return result;
+      }
+
+      friend auto operator==(const moving_pointee_iterator& lhs, const moving_pointee_iterator& rhs) noexcept -> bool{
+        return lhs.position_ == rhs.position_;
+      }
+
+      friend auto operator!=(const moving_pointee_iterator& lhs, const moving_pointee_iterator& rhs) noexcept -> bool{
+        return lhs.position_ != rhs.position_;
+      }
+
+    private:
+      T* const* position_;
+    };
 
-    static_assert(detail::is_same<Args...>::value, "for make_container all argument types needs to be the same");
-    static_assert(std::is_move_constructible<value_type>::value, "elements for container created with temporary values must be move constructible");
+    template <typename T, typename... Args>
+    auto make_container(std::false_type, Args&&... args) -> T{
+      using value_type = typename T::value_type;
+      using initializer_type = typename first_of_variadic<Args...>::type;
+      using iterator = moving_pointee_iterator<initializer_type>;
+
+      static_assert(std::is_move_constructible<value_type>::value, "elements for container created with temporary values must be move constructible");
+
+      std::array<initializer_type*, sizeof...(Args)> tmp = {{std::addressof(args)...}};
+      return {iterator(tmp.data()), iterator(tmp.data() + tmp.size())};
+    }
+
+    template <typename T, typename... Args>
+    auto make_container(std::true_type, Args&&... args) -> T{
+      using value_type = typename T::value_type;
+      using value_ref = std::reference_wrapper<const value_type>;
+      static_assert(std::is_copy_constructible<value_type>::value, "elements for container created with temporary values must be copy constructible");
+
+      std::initializer_list<value_ref> tmp{std::cref(args)...};
+      return {tmp.begin(), tmp.end()};
+    }
+
+    struct copy_values{};
+
+    // Trivially copyable elements of the container's own type are copied into a list of values, as T{args...} would
+    // do: copying is all a move of them could do, and the optimizer sees through an array of values where it keeps
+    // an array of pointers to the arguments.
+    template <typename T, typename... Args>
+    auto make_container(copy_values, Args&&... args) -> T{
+      std::initializer_list<typename T::value_type> tmp{args...};
+      return {tmp.begin(), tmp.end()};
+    }
+
+    template <typename T, typename Arg>
+    using make_container_strategy = typename std::conditional<
+        std::is_trivially_copyable<typename T::value_type>::value &&
+        std::is_same<typename std::decay<Arg>::type, typename T::value_type>::value,
+        copy_values, std::is_lvalue_reference<Arg>>::type;
 
-    std::array<value_ref, sizeof...(Args)> tmp = {std::ref(args)...};
-    auto moveable = [](decltype(tmp.begin()) it){return std::make_move_iterator(it);};
-    return {moveable(tmp.begin()), moveable(tmp.end())};
   }
 
-  template <typename T, typename... Args>
-  auto make_container(Args&&... args) -> typename std::enable_if<std::is_lvalue_reference<typename detail::first_of_variadic<Args...>::type>::value, T>::type{
-    static_assert(detail::is_same<Args...>::value, "for make_container all argument types needs to be the same");
-    using value_type = typename T::value_type;
-    using value_ref = std::reference_wrapper<const value_type>;
-    static_assert(std::is_copy_constructible<value_type>::value, "elements for container created with temporary values must be copy constructible");
+  // A single entry point dispatching on the value category of the first argument keeps overload resolution
+  // from instantiating every implementation for every call.
+  template <typename T, typename Arg, typename... Args>
+  auto make_container(Arg&& arg, Args&&... args) -> T{
+    static_assert(detail::is_same<Arg, Args...>::value, "for make_container all argument types needs to be the same");
 
-    std::initializer_list<value_ref> tmp{std::cref(args)...};
-    return {tmp.begin(), tmp.end()};
+    return detail::make_container<T>(detail::make_container_strategy<T, Arg>{}, std::forward<Arg>(arg),
+                                     std::forward<Args>(args)...);
   }
 
   template <typename T>
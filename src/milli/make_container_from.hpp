@@ -0,0 +1,452 @@
+/*
+make_container_from.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2018-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_MAKE_CONTAINER_FROM_HPP
+#define MILLI_MAKE_CONTAINER_FROM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace milli{
+
+  struct sequenced_policy{};
+
+  struct parallel_policy{
+    // threads == 0 means std::thread::hardware_concurrency(). No more threads are started
+    // than there are slices of at least min_slice elements.
+    constexpr explicit parallel_policy(std::size_t threads = 0, std::size_t min_slice = 16384) noexcept
+        : threads(threads), min_slice(min_slice) {}
+
+    std::size_t threads;
+    std::size_t min_slice;
+  };
+
+  constexpr sequenced_policy seq{};
+  constexpr parallel_policy par{};
+
+  // std::allocator replacement that default-initializes instead of value-initializing. Containers using it can be
+  // resized without zeroing trivial elements first, so make_container_from writes straight into fresh memory.
+  template <typename T>
+  struct default_init_allocator{
+    using value_type = T;
+
+    default_init_allocator() = default;
+
+    template <typename U>
+    default_init_allocator(const default_init_allocator<U>&) noexcept {}
+
+    auto allocate(std::size_t size) -> T*{
+      return std::allocator<T>().allocate(size);
+    }
+
+    auto deallocate(T* pointer, std::size_t size) noexcept -> void{
+      std::allocator<T>().deallocate(pointer, size);
+    }
+
+    template <typename U>
+    auto construct(U* pointer) noexcept(std::is_nothrow_default_constructible<U>::value) -> void{
+      ::new(static_cast<void*>(pointer)) U;
+    }
+
+    template <typename U, typename... Args>
+    auto construct(U* pointer, Args&&... args) -> void{
+      ::new(static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+    }
+  };
+
+  template <typename T, typename U>
+  auto operator==(const default_init_allocator<T>&, const default_init_allocator<U>&) noexcept -> bool{
+    return true;
+  }
+
+  template <typename T, typename U>
+  auto operator!=(const default_init_allocator<T>&, const default_init_allocator<U>&) noexcept -> bool{
+    return false;
+  }
+
+  namespace detail{
+
+    template <typename T>
+    auto destroy(T* first, T* last) noexcept -> void{
+      for(; first != last; ++first)
+        first->~T();
+    }
+
+    // Raw storage for `size` elements. Owns the first `constructed` of them once they are handed over.
+    template <typename T>
+    class uninitialized_buffer{
+    public:
+      explicit uninitialized_buffer(std::size_t size)
+          : data_(size ? std::allocator<T>().allocate(size) : nullptr), size_(size), constructed_(0) {}
+
+      uninitialized_buffer(const uninitialized_buffer&) = delete;
+      auto operator=(const uninitialized_buffer&) -> uninitialized_buffer& = delete;
+
+      ~uninitialized_buffer(){
+        destroy(data_, data_ + constructed_);
+        if(data_)
+          std::allocator<T>().deallocate(data_, size_);
+      }
+
+      auto data() noexcept -> T*{
+        return data_;
+      }
+
+      auto size() const noexcept -> std::size_t{
+        return size_;
+      }
+
+      auto adopt_all() noexcept -> void{
+        constructed_ = size_;
+      }
+
+    private:
+      T* data_;
+      std::size_t size_;
+      std::size_t constructed_;
+    };
+
+    template <typename Generator>
+    struct index_source{
+      auto operator()(std::size_t index) const -> decltype(std::declval<const Generator&>()(index)){
+        return generator(index);
+      }
+
+      const Generator& generator;
+    };
+
+    template <typename Iterator, typename Generator>
+    struct range_source{
+      auto operator()(std::size_t index) const -> decltype(std::declval<const Generator&>()(*std::declval<Iterator>())){
+        return generator(first[static_cast<typename std::iterator_traits<Iterator>::difference_type>(index)]);
+      }
+
+      Iterator first;
+      const Generator& generator;
+    };
+
+    // Constructs [first, last) in place. Either the whole slice is constructed or nothing is left behind.
+    template <typename T, typename Source>
+    auto construct_slice(T* out, std::size_t first, std::size_t last, const Source& source) -> void{
+      std::size_t current = first;
+      try{
+        for(; current != last; ++current)
+          ::new(static_cast<void*>(out + current)) T(source(current));
+      } catch(...){
+        destroy(out + first, out + current);
+        throw;
+      }
+    }
+
+    // Joins the workers still running when it goes out of scope, so that no exception can unwind past a joinable
+    // thread.
+    struct thread_joiner{
+      ~thread_joiner(){
+        for(auto& worker : workers){
+          if(worker.joinable())
+            worker.join();
+        }
+      }
+
+      std::vector<std::thread>& workers;
+    };
+
+    template <typename T, typename Source>
+    auto construct_all(T* out, std::size_t size, const Source& source, sequenced_policy) -> void{
+      construct_slice(out, 0, size, source);
+    }
+
+    template <typename T, typename Source>
+    auto construct_all(T* out, std::size_t size, const Source& source, parallel_policy policy) -> void{
+      std::size_t threads = policy.threads ? policy.threads : std::thread::hardware_concurrency();
+      threads = std::min(threads, size / std::max<std::size_t>(policy.min_slice, 1));
+
+      if(threads <= 1)
+        return construct_slice(out, 0, size, source);
+
+      auto slice_begin = [size, threads](std::size_t slice){
+        return size / threads * slice + std::min(slice, size % threads);
+      };
+
+      std::vector<std::exception_ptr> errors(threads);
+      auto fill = [&](std::size_t slice){
+        try{
+          construct_slice(out, slice_begin(slice), slice_begin(slice + 1), source);
+        } catch(...){
+          errors[slice] = std::current_exception();
+        }
+      };
+
+      // A slice whose thread can not be started, for lack of resources or memory, is filled on this thread.
+      std::vector<std::thread> workers;
+      thread_joiner joiner{workers};
+      workers.reserve(threads - 1);
+      for(std::size_t slice = 1; slice < threads; ++slice){
+        try{
+          workers.emplace_back(fill, slice);
+        } catch(...){
+          fill(slice);
+        }
+      }
+      fill(0);
+
+      for(auto& worker : workers)
+        worker.join();
+
+      auto failed = std::find_if(errors.begin(), errors.end(), [](const std::exception_ptr& error){ return bool(error); });
+      if(failed == errors.end())
+        return;
+
+      for(std::size_t slice = 0; slice < threads; ++slice){
+        if(not errors[slice])
+          destroy(out + slice_begin(slice), out + slice_begin(slice + 1));
+      }
+      std::rethrow_exception(*failed);
+    }
+
+    template <typename...T>
+    struct void_type {
+      using type = void;
+    };
+
+    // Contiguous containers of trivial elements, which threads can fill in place once they are sized.
+    template <typename Container, typename = void>
+    struct fills_in_place : std::false_type {};
+
+    template <typename Container>
+    struct fills_in_place<Container, typename void_type<
+        decltype(std::declval<Container&>().resize(std::size_t())),
+        decltype(static_cast<typename Container::value_type*>(std::declval<Container&>().data()))>::type>
+        : std::integral_constant<bool, std::is_trivial<typename Container::value_type>::value &&
+                                       std::is_default_constructible<typename Container::value_type>::value> {};
+
+    // Random access iterator over source(0), source(1), ... converted to T: the range constructor of a container
+    // constructs each element from it directly in the storage it allocated once. Dereferencing yields a proxy that
+    // converts to T, so that the element is initialized by the conversion instead of moved from a temporary.
+    template <typename T, typename Source>
+    class generating_iterator{
+    public:
+      struct generated{
+        operator T() const{
+          return T(source(index));
+        }
+
+        const Source& source;
+        std::size_t index;
+      };
+
+      using value_type = T;
+      using reference = generated;
+      using pointer = void;
+      using difference_type = std::ptrdiff_t;
+      using iterator_category = std::random_access_iterator_tag;
+
+      generating_iterator(const Source& source, std::size_t index) noexcept : source_(&source), index_(index) {}
+
+      auto operator*() const -> reference{
+        return generated{*source_, index_};
+      }
+
+      auto operator[](difference_type offset) const -> reference{
+        return *(*this + offset);
+      }
+
+      auto operator++() noexcept -> generating_iterator&{
+        ++index_;
+        return *this;
+      }
+
+      auto operator++(int) noexcept -> generating_iterator{
+        auto result = *this;
+        ++index_;
+        return result;
+      }
+
+      auto operator--() noexcept -> generating_iterator&{
+        --index_;
+        return *this;
+      }
+
+      auto operator--(int) noexcept -> generating_iterator{
+        auto result = *this;
+        --index_;
+        return result;
+      }
+
+      auto operator+=(difference_type offset) noexcept -> generating_iterator&{
+        index_ = static_cast<std::size_t>(static_cast<difference_type>(index_) + offset);
+        return *this;
+      }
+
+      auto operator-=(difference_type offset) noexcept -> generating_iterator&{
+        return *this += -offset;
+      }
+
+      friend auto operator+(generating_iterator iterator, difference_type offset) noexcept -> generating_iterator{
+        return iterator += offset;
+      }
+
+      friend auto operator+(difference_type offset, generating_iterator iterator) noexcept -> generating_iterator{
+        return iterator += offset;
+      }
+
+      friend auto operator-(generating_iterator iterator, difference_type offset) noexcept -> generating_iterator{
+        return iterator -= offset;
+      }
+
+      friend auto operator-(const generating_iterator& lhs, const generating_iterator& rhs) noexcept
+      -> difference_type{
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+      }
+
+      friend auto operator==(const generating_iterator& lhs, const generating_iterator& rhs) noexcept -> bool{
+        return lhs.index_ == rhs.index_;
+      }
+
+      friend auto operator!=(const generating_iterator& lhs, const generating_iterator& rhs) noexcept -> bool{
+        return lhs.index_ != rhs.index_;
+      }
+
+      friend auto operator<(const generating_iterator& lhs, const generating_iterator& rhs) noexcept -> bool{
+        return lhs.index_ < rhs.index_;
+      }
+
+      friend auto operator>(const generating_iterator& lhs, const generating_iterator& rhs) noexcept -> bool{
+        return rhs < lhs;
+      }
+
+      friend auto operator<=(const generating_iterator& lhs, const generating_iterator& rhs) noexcept -> bool{
+        return not (rhs < lhs);
+      }
+
+      friend auto operator>=(const generating_iterator& lhs, const generating_iterator& rhs) noexcept -> bool{
+        return not (lhs < rhs);
+      }
+
+    private:
+      const Source* source_;
+      std::size_t index_;
+    };
+
+    template <typename Container, typename Source>
+    auto materialize(std::size_t size, const Source& source, sequenced_policy) -> Container{
+      using iterator = generating_iterator<typename Container::value_type, Source>;
+      return Container(iterator(source, 0), iterator(source, size));
+    }
+
+    // Threads need the storage of the container before its elements exist. Trivial elements are sized in place,
+    // which std::allocator zeroes first and default_init_allocator does not.
+    template <typename Container, typename Source>
+    auto materialize_parallel(std::size_t size, const Source& source, parallel_policy policy, std::true_type)
+    -> Container{
+      Container result;
+      result.resize(size);
+      construct_all(result.data(), size, source, policy);
+      return result;
+    }
+
+    // Other elements are constructed in a staging buffer and moved into the container: twice the memory at the peak
+    // and one more move per element.
+    template <typename Container, typename Source>
+    auto materialize_parallel(std::size_t size, const Source& source, parallel_policy policy, std::false_type)
+    -> Container{
+      using value_type = typename Container::value_type;
+
+      uninitialized_buffer<value_type> buffer(size);
+      construct_all(buffer.data(), size, source, policy);
+      buffer.adopt_all();
+
+      return Container(std::make_move_iterator(buffer.data()), std::make_move_iterator(buffer.data() + size));
+    }
+
+    template <typename Container, typename Source>
+    auto materialize(std::size_t size, const Source& source, parallel_policy policy) -> Container{
+      return materialize_parallel<Container>(size, source, policy, fills_in_place<Container>{});
+    }
+
+    template <typename Container, typename Iterator, typename Generator, typename Policy>
+    auto materialize_range(Iterator first, Iterator last, const Generator& generator, Policy policy,
+                           std::random_access_iterator_tag) -> Container{
+      auto size = static_cast<std::size_t>(std::distance(first, last));
+      return materialize<Container>(size, range_source<Iterator, Generator>{first, generator}, policy);
+    }
+
+    // Without random access the range can not be split into slices, so it is walked once on the calling thread.
+    template <typename Container, typename Iterator, typename Generator, typename Policy>
+    auto materialize_range(Iterator first, Iterator last, const Generator& generator, Policy,
+                           std::input_iterator_tag) -> Container{
+      using value_type = typename Container::value_type;
+
+      std::vector<value_type> staging;
+      for(; first != last; ++first)
+        staging.push_back(generator(*first));
+
+      return Container(std::make_move_iterator(staging.begin()), std::make_move_iterator(staging.end()));
+    }
+
+  }
+
+  // Builds a container of `size` elements, where element i is generator(i).
+  //
+  // Sequentially, the container is range constructed from the generated values: it allocates once and initializes
+  // each element in place from the generator result, nothing is default constructed, staged or moved.
+  // In parallel, threads fill disjoint slices of storage sized once:
+  // - contiguous containers of trivial elements are resized and written in place. std::allocator zeroes them on
+  //   resize, a memset pass; default_init_allocator skips it;
+  // - other elements are constructed in an uninitialized staging buffer, never default constructed, and moved into
+  //   the container. This doubles the peak memory and adds a move per element.
+  // The generator must be safe to call concurrently when a parallel policy is used.
+  //
+  // If any generator call throws, every element constructed so far is destroyed, the storage is released and the
+  // first exception (in slice order) is rethrown. No partially built container is ever observable.
+  template <typename Container, typename Size, typename Generator, typename Policy = sequenced_policy>
+  auto make_container_from(Size size, Generator generator, Policy policy = Policy{})
+  -> typename std::enable_if<std::is_integral<Size>::value, Container>::type{
+    using value_type = typename Container::value_type;
+    static_assert(std::is_move_constructible<value_type>::value, "elements for make_container_from must be move constructible");
+    static_assert(std::is_constructible<value_type, decltype(generator(std::size_t()))>::value,
+                  "generator result must be convertible to the container value_type");
+
+    return detail::materialize<Container>(static_cast<std::size_t>(size), detail::index_source<Generator>{generator}, policy);
+  }
+
+  // Builds a container with one element, generator(element), per element of the range. Ranges without random access
+  // iterators are always processed on the calling thread.
+  template <typename Container, typename Range, typename Generator, typename Policy = sequenced_policy>
+  auto make_container_from(const Range& range, Generator generator, Policy policy = Policy{})
+  -> typename std::enable_if<not std::is_integral<Range>::value, decltype(std::begin(range), std::end(range), Container())>::type{
+    using value_type = typename Container::value_type;
+    using iterator = decltype(std::begin(range));
+    using category = typename std::iterator_traits<iterator>::iterator_category;
+    static_assert(std::is_move_constructible<value_type>::value, "elements for make_container_from must be move constructible");
+    static_assert(std::is_constructible<value_type, decltype(generator(*std::begin(range)))>::value,
+                  "generator result must be convertible to the container value_type");
+
+    return detail::materialize_range<Container>(std::begin(range), std::end(range), generator, policy, category{});
+  }
+
+}
+
+#endif //MILLI_MAKE_CONTAINER_FROM_HPP
@@ -0,0 +1,389 @@
+/*
+memoize.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_MEMOIZE_HPP
+#define MILLI_LIBRARY_MEMOIZE_HPP
+
+#include <milli/attributes.hpp>
+#include <milli/optional.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace milli {
+
+  // Cache of the results of Function, a pure function of one Key, for use by many threads at once.
+  //
+  // The cache is split into shards. Each is an open addressing table whose slots keep their entry in detail::optional
+  // storage. A key lives in one of the probe_window slots following its home slot. When they are all taken, one is
+  // evicted with the CLOCK algorithm: reads set a slot's referenced bit, and eviction takes the first slot of the
+  // window whose bit is clear, clearing the bits it passes.
+  //
+  // Writers of a shard take its mutex and bump its sequence counter around every change. When Key and Value are
+  // trivially copyable, reads are lock-free: slots keep their entry in atomic words, readers copy a slot and only use
+  // the copy once an unchanged sequence proved that no writer ran meanwhile, or retry. Other types are read under the
+  // mutex. Concurrent misses on one key call Function once; the other
+  // callers wait for the result, or for the exception it threw.
+  template<typename Key, typename Value, typename Function, typename Hash = std::hash<Key>,
+      typename Equal = std::equal_to<Key>>
+  class memoized {
+  public:
+    using key_type = Key;
+    using value_type = Value;
+
+    static constexpr std::size_t probe_window = 8;
+
+    memoized(Function function, std::size_t capacity, std::size_t shards = 16, Hash hash = Hash(),
+             Equal equal = Equal())
+        : function_(std::move(function)), hash_(std::move(hash)), equal_(std::move(equal)) {
+      shard_bits_ = 0;
+      while ((std::size_t(1) << shard_bits_) < shards)
+        ++shard_bits_;
+
+      std::size_t shard_count = std::size_t(1) << shard_bits_;
+      std::size_t per_shard = probe_window;
+      while (per_shard * shard_count < capacity)
+        per_shard *= 2;
+
+      shards_.reset(new shard[shard_count]);
+      for (std::size_t index = 0; index != shard_count; ++index) {
+        shards_[index].slots.reset(new slot[per_shard]);
+        shards_[index].mask = per_shard - 1;
+      }
+    }
+
+    auto operator()(const Key& key) const -> Value {
+      auto hash = mix(hash_(key));
+      shard& owner = shards_[shard_bits_ == 0 ? 0 : hash >> (64 - shard_bits_)];
+      auto home = static_cast<std::size_t>(hash);
+
+      detail::optional<Value> cached;
+      if (lookup(owner, home, key, cached, std::integral_constant<bool, optimistic>()))
+        return std::move(*cached);
+      return miss(owner, home, key);
+    }
+
+    // Entries currently cached. Locks every shard in turn.
+    auto size() const -> std::size_t {
+      std::size_t result = 0;
+      for (std::size_t index = 0; index != shard_count(); ++index) {
+        std::lock_guard<std::mutex> lock(shards_[index].mutex);
+        result += shards_[index].size;
+      }
+      return result;
+    }
+
+    auto capacity() const noexcept -> std::size_t {
+      return shard_count() * (shards_[0].mask + 1);
+    }
+
+    // Drops every entry; calls running concurrently may still insert theirs afterwards.
+    auto clear() -> void {
+      for (std::size_t index = 0; index != shard_count(); ++index) {
+        shard& cleared = shards_[index];
+        std::lock_guard<std::mutex> lock(cleared.mutex);
+        begin_write(cleared);
+        for (std::size_t position = 0; position <= cleared.mask; ++position) {
+          slot& emptied = cleared.slots[position];
+          if (emptied.full.load(std::memory_order_relaxed)) {
+            emptied.full.store(false, std::memory_order_relaxed);
+            emptied.storage.reset();
+          }
+        }
+        cleared.size = 0;
+        end_write(cleared);
+      }
+    }
+
+  private:
+    static constexpr bool optimistic = std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value;
+
+    struct entry {
+      template<typename StoredValue>
+      entry(const Key& key, StoredValue&& value) : key(key), value(std::forward<StoredValue>(value)) {}
+
+      Key key;
+      Value value;
+    };
+
+    using entry_buffer = typename std::aligned_storage<sizeof(entry), alignof(entry)>::type;
+
+    // Entry of a trivially copyable type as atomic words. Readers copy them while a writer may be storing new ones,
+    // which is only defined for atomics; a copy may be torn until the sequence check passed.
+    struct word_storage {
+      static constexpr std::size_t word_count = (sizeof(entry) + sizeof(std::uintptr_t) - 1) / sizeof(std::uintptr_t);
+
+      auto store(const Key& key, const Value& value) noexcept -> void {
+        entry stored(key, value);
+        std::uintptr_t buffer[word_count] = {};
+        std::memcpy(buffer, &stored, sizeof(entry));
+        for (std::size_t index = 0; index != word_count; ++index)
+          words[index].store(buffer[index], std::memory_order_relaxed);
+      }
+
+      auto reset() noexcept -> void {}
+
+      auto load(entry_buffer& copy) const noexcept -> const entry& {
+        std::uintptr_t buffer[word_count];
+        for (std::size_t index = 0; index != word_count; ++index)
+          buffer[index] = words[index].load(std::memory_order_relaxed);
+        std::memcpy(&copy, buffer, sizeof(entry));
+        return *reinterpret_cast<const entry*>(&copy);
+      }
+
+      std::atomic<std::uintptr_t> words[word_count];
+    };
+
+    // Entry of any other type, only accessed under the shard mutex.
+    struct optional_storage {
+      auto store(const Key& key, const Value& value) -> void {
+        stored.emplace(key, value);
+      }
+
+      auto reset() noexcept -> void {
+        stored.reset();
+      }
+
+      auto load(entry_buffer&) const noexcept -> const entry& {
+        return *stored;
+      }
+
+      detail::optional<entry> stored;
+    };
+
+    struct slot {
+      std::atomic<bool> full{false};
+      std::atomic<bool> referenced{false};
+      typename std::conditional<optimistic, word_storage, optional_storage>::type storage;
+    };
+
+    // A miss being computed. Callers missing the same key meanwhile wait on ready under the shard mutex.
+    struct pending {
+      explicit pending(const Key& key) : key(key) {}
+
+      Key key;
+      detail::optional<Value> value;
+      std::exception_ptr error;
+      std::size_t waiters = 0;
+      bool done = false;
+      std::condition_variable ready;
+    };
+
+    // Padded, so that the sequence counters of neighbouring shards do not share a cache line.
+    struct shard {
+      std::atomic<std::uint64_t> sequence{0};
+      std::unique_ptr<slot[]> slots;
+      std::size_t mask = 0;
+      std::size_t size = 0;
+      mutable std::mutex mutex;
+      std::vector<std::shared_ptr<pending>> misses;
+      char padding[64];
+    };
+
+    static auto mix(std::size_t hash) noexcept -> std::uint64_t {
+      std::uint64_t result = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+      return result ^ (result >> 29);
+    }
+
+    auto shard_count() const noexcept -> std::size_t {
+      return std::size_t(1) << shard_bits_;
+    }
+
+    static auto begin_write(shard& written) noexcept -> void {
+      written.sequence.store(written.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    static auto end_write(shard& written) noexcept -> void {
+      written.sequence.store(written.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    static auto touch(slot& used) noexcept -> void {
+      if (not used.referenced.load(std::memory_order_relaxed))
+        used.referenced.store(true, std::memory_order_relaxed);
+    }
+
+    // Seqlock read, slot by slot: each copy is validated against the sequence before equal_ sees it, so user code
+    // never runs on torn bytes. The first slot usually holds the key, and then costs a single check.
+    auto lookup(shard& owner, std::size_t home, const Key& key, detail::optional<Value>& result, std::true_type) const
+    -> bool {
+      for (;;) {
+        auto sequence = owner.sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+          std::this_thread::yield();
+          continue;
+        }
+
+        bool torn = false;
+        for (std::size_t probe = 0; probe != probe_window && not torn; ++probe) {
+          slot& candidate = owner.slots[(home + probe) & owner.mask];
+          bool full = candidate.full.load(std::memory_order_relaxed);
+          entry_buffer buffer;
+          const entry* copy = full ? &candidate.storage.load(buffer) : nullptr;
+
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (owner.sequence.load(std::memory_order_relaxed) != sequence) {
+            torn = true;
+          } else if (not copy) {
+            return false;
+          } else if (equal_(copy->key, key)) {
+            touch(candidate);
+            result.emplace(copy->value);
+            return true;
+          }
+        }
+        if (not torn)
+          return false;
+      }
+    }
+
+    auto lookup(shard& owner, std::size_t home, const Key& key, detail::optional<Value>& result, std::false_type) const
+    -> bool {
+      std::lock_guard<std::mutex> lock(owner.mutex);
+      if (slot* found = find_locked(owner, home, key)) {
+        touch(*found);
+        entry_buffer buffer;
+        result.emplace(found->storage.load(buffer).value);
+        return true;
+      }
+      return false;
+    }
+
+    auto find_locked(shard& owner, std::size_t home, const Key& key) const -> slot* {
+      for (std::size_t probe = 0; probe != probe_window; ++probe) {
+        slot& candidate = owner.slots[(home + probe) & owner.mask];
+        if (not candidate.full.load(std::memory_order_relaxed))
+          return nullptr;
+        entry_buffer buffer;
+        if (equal_(candidate.storage.load(buffer).key, key))
+          return &candidate;
+      }
+      return nullptr;
+    }
+
+    MILLI_NOINLINE auto miss(shard& owner, std::size_t home, const Key& key) const -> Value {
+      std::unique_lock<std::mutex> lock(owner.mutex);
+      if (slot* found = find_locked(owner, home, key)) {
+        entry_buffer buffer;
+        return found->storage.load(buffer).value;
+      }
+
+      for (auto& computing : owner.misses) {
+        if (equal_(computing->key, key)) {
+          std::shared_ptr<pending> waited = computing;
+          ++waited->waiters;
+          waited->ready.wait(lock, [&waited] { return waited->done; });
+          if (waited->error)
+            std::rethrow_exception(waited->error);
+          return *waited->value;
+        }
+      }
+
+      auto computing = std::make_shared<pending>(key);
+      owner.misses.push_back(computing);
+      lock.unlock();
+
+      detail::optional<Value> value;
+      std::exception_ptr error;
+      try {
+        value.emplace(function_(key));
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      lock.lock();
+      if (not error)
+        insert(owner, home, key, *value);
+      for (auto position = owner.misses.begin(); position != owner.misses.end(); ++position) {
+        if (*position == computing) {
+          owner.misses.erase(position);
+          break;
+        }
+      }
+      if (computing->waiters != 0) {
+        if (error)
+          computing->error = error;
+        else
+          computing->value.emplace(*value);
+        computing->done = true;
+        computing->ready.notify_all();
+      }
+      lock.unlock();
+
+      if (error)
+        std::rethrow_exception(error);
+      return std::move(*value);
+    }
+
+    // Takes the first free slot of the window, or the CLOCK victim: the first slot, from home on, whose referenced bit
+    // is clear; bits of the slots passed are cleared, so a second round always finds one. New entries start with a
+    // clear bit, only entries read since the hand last passed get a second chance.
+    auto insert(shard& owner, std::size_t home, const Key& key, const Value& value) const -> void {
+      slot* target = nullptr;
+      for (std::size_t probe = 0; probe != probe_window && not target; ++probe) {
+        slot& candidate = owner.slots[(home + probe) & owner.mask];
+        if (not candidate.full.load(std::memory_order_relaxed))
+          target = &candidate;
+      }
+      for (std::size_t probe = 0; probe != 2 * probe_window && not target; ++probe) {
+        slot& candidate = owner.slots[(home + probe % probe_window) & owner.mask];
+        if (candidate.referenced.load(std::memory_order_relaxed))
+          candidate.referenced.store(false, std::memory_order_relaxed);
+        else
+          target = &candidate;
+      }
+
+      begin_write(owner);
+      if (target->full.load(std::memory_order_relaxed))
+        target->storage.reset();
+      else
+        ++owner.size;
+      target->storage.store(key, value);
+      target->referenced.store(false, std::memory_order_relaxed);
+      target->full.store(true, std::memory_order_relaxed);
+      end_write(owner);
+    }
+
+    Function function_;
+    Hash hash_;
+    Equal equal_;
+    unsigned shard_bits_;
+    std::unique_ptr<shard[]> shards_;
+  };
+
+  // memoize<Key>(function, capacity, shards) caches function, called with a const Key&, in a memoized of about
+  // capacity entries split into shards shards. Both are rounded up to powers of two.
+  template<typename Key, typename Function>
+  auto memoize(Function function, std::size_t capacity, std::size_t shards = 16)
+  -> memoized<Key, typename std::decay<decltype(std::declval<const Function&>()(std::declval<const Key&>()))>::type,
+      Function> {
+    return memoized<Key, typename std::decay<decltype(std::declval<const Function&>()(std::declval<const Key&>()))>::type,
+        Function>(std::move(function), capacity, shards);
+  }
+
+}
+
+#endif //MILLI_LIBRARY_MEMOIZE_HPP
@@ -17,34 +17,110 @@ not_empty.hpp: This file is part of the Milli Library.
 #ifndef MILLI_LIBRARY_NOT_EMPTY_BASE_HPP
 #define MILLI_LIBRARY_NOT_EMPTY_BASE_HPP
 
+#include <milli/assume.hpp>
+#include <milli/relocate.hpp>
+#include <milli/source_site.hpp>
 #include <cstddef>
+#include <functional>
+#include <memory>
 #include <type_traits>
 #include <utility>
 
-#ifdef __cpp_lib_optional
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<optional>)
 #include <optional>
 #endif
+#if __has_include(<string_view>)
+#include <string_view>
+#endif
+#endif
 
 namespace milli {
 
+  // Access policies of not_empty_base. With check_on_access the error handler runs again on every access (C++14 and
+  // later). With check_once it only runs at construction; accesses then just let the optimizer assume a non-empty
+  // value, which also removes null checks in the code that uses the dereferenced value.
+  struct check_on_access {};
+  struct check_once {};
+
   namespace detail {
     struct no_error_handler {
       void operator()(bool condition) noexcept {}
     };
+
+    // Error handlers that record where a value was made get the source site, the others only the condition.
+    template<typename ErrorHandler>
+    auto report_at(ErrorHandler&& handler, bool condition, const source_site& site, int)
+    noexcept(noexcept(handler(condition, site))) -> decltype(handler(condition, site), void()) {
+      handler(condition, site);
+    }
+
+    template<typename ErrorHandler>
+    auto report_at(ErrorHandler&& handler, bool condition, const source_site&, long)
+    noexcept(noexcept(handler(condition))) -> void {
+      handler(condition);
+    }
+
+    template<typename ErrorHandler, typename AccessPolicy>
+    struct access_check;
+
+    template<typename ErrorHandler>
+    struct access_check<ErrorHandler, check_on_access> {
+      static constexpr bool is_noexcept = noexcept(std::declval<ErrorHandler>()(false));
+
+#if __cpp_constexpr >= 201304
+      static constexpr void check(bool condition) noexcept(is_noexcept) {
+        ErrorHandler()(condition);
+      }
+#endif
+    };
+
+    template<typename ErrorHandler>
+    struct access_check<ErrorHandler, check_once> {
+      static constexpr bool is_noexcept = true;
+
+#if __cpp_constexpr >= 201304
+      static constexpr void check(bool condition) noexcept {
+        MILLI_ASSUME(condition);
+      }
+#endif
+    };
+
+    struct not_empty_access;
+  }
+
+  template<typename T, typename ErrorHandler, typename AccessPolicy>
+  class not_empty_base;
+
+  namespace detail {
+    template<typename T, typename ErrorHandler, typename AccessPolicy>
+    auto is_not_empty_test(const not_empty_base<T, ErrorHandler, AccessPolicy>*) -> std::true_type;
+
+    auto is_not_empty_test(const void*) -> std::false_type;
+
+    // Whether T is not_empty_base or one of the not_empty_X classes deriving from it.
+    template<typename T>
+    struct is_not_empty : decltype(is_not_empty_test(static_cast<const T*>(nullptr))) {};
+
+    template<typename T>
+    using enable_if_not_wrapped = typename std::enable_if<not is_not_empty<T>::value>::type;
   }
 
-  template<typename T, typename ErrorHandler = detail::no_error_handler>
+  template<typename T, typename ErrorHandler = detail::no_error_handler, typename AccessPolicy = check_on_access>
   class not_empty_base {
   public:
     using stored_type  = T;
-    using element_type = typename std::remove_cv<typename std::remove_reference<decltype(*std::declval<stored_type>())>::type>::type;
+    using element_type = typename std::remove_reference<decltype(*std::declval<stored_type>())>::type;
+    using trivially_relocatable =
+        trivially_relocatable_as<not_empty_base, is_trivially_relocatable<stored_type>::value>;
 
   private:
     static constexpr bool is_dereference_noexcept = noexcept(*std::declval<stored_type>());
     static constexpr bool is_error_check_noexcept = noexcept(std::declval<ErrorHandler>()(false));
+    using access_check = detail::access_check<ErrorHandler, AccessPolicy>;
     static constexpr bool is_cpp14_error_check_noexcept =
 #if __cpp_constexpr >= 201304
-        is_error_check_noexcept
+        access_check::is_noexcept
 #else
     true
 #endif
@@ -58,10 +134,11 @@ namespace milli {
 #if __cpp_constexpr >= 201304
     constexpr
 #endif
-    not_empty_base(U&& value) noexcept(std::is_nothrow_constructible<stored_type, decltype((std::forward<U>(
-        value)))>::value && is_error_check_noexcept)
+    not_empty_base(U&& value, source_site site = source_site::current())
+    noexcept(std::is_nothrow_constructible<stored_type, decltype((std::forward<U>(value)))>::value &&
+             is_error_check_noexcept)
         : value_(std::forward<U>(value)) {
-      ErrorHandler()(static_cast<bool>(value_));
+      detail::report_at(ErrorHandler(), static_cast<bool>(value_), site, 0);
     }
 
     not_empty_base(std::nullptr_t) = delete;
@@ -84,59 +161,118 @@ namespace milli {
 
     auto operator*() noexcept(is_dereference_noexcept && is_cpp14_error_check_noexcept) -> element_type& {
 #if __cpp_constexpr >= 201304
-      ErrorHandler()(static_cast<bool>(value_));
+      access_check::check(static_cast<bool>(value_));
 #endif
       return *value_;
     }
 
     constexpr auto operator*() const noexcept(is_dereference_noexcept && is_cpp14_error_check_noexcept) -> const element_type& {
 #if __cpp_constexpr >= 201304
-      ErrorHandler()(static_cast<bool>(value_));
+      access_check::check(static_cast<bool>(value_));
 #endif
       return *value_;
     }
 
     auto operator->() noexcept(is_dereference_noexcept && is_cpp14_error_check_noexcept) -> element_type* {
 #if __cpp_constexpr >= 201304
-      ErrorHandler()(static_cast<bool>(value_));
+      access_check::check(static_cast<bool>(value_));
 #endif
       return &*(*this);
     }
 
-    constexpr auto operator->() const noexcept(is_dereference_noexcept && is_cpp14_error_check_noexcept) -> element_type* {
+    constexpr auto operator->() const noexcept(is_dereference_noexcept && is_cpp14_error_check_noexcept) -> const element_type* {
 #if __cpp_constexpr >= 201304
-      ErrorHandler()(static_cast<bool>(value_));
+      access_check::check(static_cast<bool>(value_));
 #endif
       return &*(*this);
     }
 
     constexpr auto get() const noexcept(is_cpp14_error_check_noexcept) -> const stored_type& {
 #if __cpp_constexpr >= 201304
-      ErrorHandler()(static_cast<bool>(value_));
+      access_check::check(static_cast<bool>(value_));
 #endif
       return value_;
     }
 
     auto get() noexcept(is_cpp14_error_check_noexcept) -> stored_type& {
 #if __cpp_constexpr >= 201304
-      ErrorHandler()(static_cast<bool>(value_));
+      access_check::check(static_cast<bool>(value_));
 #endif
       return value_;
     }
 
-    template<typename U, typename = typename std::enable_if<
-        std::is_convertible<U, stored_type>::value>::type>
-#if __cpp_constexpr >= 201304
-    constexpr
-#endif
-    auto operator=(not_empty_base<U>&& value)
-    noexcept(noexcept(std::declval<stored_type&>() = std::forward<U>(value)))
+    not_empty_base(const not_empty_base&) = default;
+    not_empty_base(not_empty_base&&) = default;
+
+    // Assignments run the error handler on the value assigned, like construction does: the source may have been
+    // moved from, and under check_once no access would notice. The source is checked before it is assigned, so a
+    // throwing handler leaves the target untouched. Operators can not take a defaulted source_site; assign reports
+    // the site of its caller, operator= an unknown one. Flavours bring operator= into scope, or their implicit ones
+    // would take another flavour by converting it through get(), which assumes the value under check_once.
+    template<typename U, typename E, typename P, typename = typename std::enable_if<
+        std::is_assignable<stored_type&, const U&>::value>::type>
+    auto assign(const not_empty_base<U, E, P>& other, source_site site = source_site::current())
+    noexcept(std::is_nothrow_assignable<stored_type&, const U&>::value && is_error_check_noexcept)
+    -> not_empty_base& {
+      detail::report_at(ErrorHandler(), static_cast<bool>(other.value_), site, 0);
+      value_ = other.value_;
+      return *this;
+    }
+
+    template<typename U, typename E, typename P, typename = typename std::enable_if<
+        std::is_assignable<stored_type&, U&&>::value>::type>
+    auto assign(not_empty_base<U, E, P>&& other, source_site site = source_site::current())
+    noexcept(std::is_nothrow_assignable<stored_type&, U&&>::value && is_error_check_noexcept)
     -> not_empty_base& {
-      ErrorHandler()(static_cast<bool>(value_));
+      detail::report_at(ErrorHandler(), static_cast<bool>(other.value_), site, 0);
+      value_ = std::move(other.value_);
+      return *this;
+    }
+
+    template<typename U, typename = detail::enable_if_not_wrapped<typename std::decay<U>::type>,
+        typename = typename std::enable_if<std::is_convertible<U, stored_type>::value &&
+                                           std::is_assignable<stored_type&, U&&>::value>::type>
+    auto assign(U&& value, source_site site = source_site::current())
+    noexcept(std::is_nothrow_assignable<stored_type&, U&&>::value && is_error_check_noexcept) -> not_empty_base& {
+      detail::report_at(ErrorHandler(), static_cast<bool>(value), site, 0);
       value_ = std::forward<U>(value);
       return *this;
     }
 
+    auto operator=(const not_empty_base& other)
+    noexcept(std::is_nothrow_copy_assignable<stored_type>::value && is_error_check_noexcept) -> not_empty_base& {
+      return assign(other, unknown_site());
+    }
+
+    auto operator=(not_empty_base&& other)
+    noexcept(std::is_nothrow_move_assignable<stored_type>::value && is_error_check_noexcept) -> not_empty_base& {
+      return assign(std::move(other), unknown_site());
+    }
+
+    template<typename U, typename = detail::enable_if_not_wrapped<typename std::decay<U>::type>,
+        typename = typename std::enable_if<std::is_convertible<U, stored_type>::value &&
+                                           std::is_assignable<stored_type&, U&&>::value>::type>
+    auto operator=(U&& value)
+    noexcept(std::is_nothrow_assignable<stored_type&, U&&>::value && is_error_check_noexcept) -> not_empty_base& {
+      return assign(std::forward<U>(value), unknown_site());
+    }
+
+    template<typename U, typename E, typename P, typename = typename std::enable_if<
+        std::is_assignable<stored_type&, const U&>::value>::type>
+    auto operator=(const not_empty_base<U, E, P>& other)
+    noexcept(std::is_nothrow_assignable<stored_type&, const U&>::value && is_error_check_noexcept)
+    -> not_empty_base& {
+      return assign(other, unknown_site());
+    }
+
+    template<typename U, typename E, typename P, typename = typename std::enable_if<
+        std::is_assignable<stored_type&, U&&>::value>::type>
+    auto operator=(not_empty_base<U, E, P>&& other)
+    noexcept(std::is_nothrow_assignable<stored_type&, U&&>::value && is_error_check_noexcept)
+    -> not_empty_base& {
+      return assign(std::move(other), unknown_site());
+    }
+
     auto operator=(std::nullptr_t) -> not_empty_base& = delete;
     auto operator=(const std::nullptr_t&) -> not_empty_base& = delete;
     auto operator=(const std::nullptr_t&&) -> not_empty_base& = delete;
@@ -148,8 +284,198 @@ namespace milli {
 #endif
 
   private:
+    template<typename, typename, typename>
+    friend class not_empty_base;
+
+    static constexpr auto unknown_site() noexcept -> source_site {
+      return source_site{"unknown", "unknown", 0};
+    }
+
+    friend struct detail::not_empty_access;
+
     stored_type value_;
   };
+
+  namespace detail {
+
+    // The stored value without the access check: comparisons and hashing need no check, the value is never empty.
+    struct not_empty_access {
+      template<typename T, typename ErrorHandler, typename AccessPolicy>
+      static constexpr auto stored(const not_empty_base<T, ErrorHandler, AccessPolicy>& value) noexcept -> const T& {
+        return value.value_;
+      }
+    };
+
+    // What keys are hashed and compared by: the stored value of not_empty wrappers, the pointer of smart pointers and,
+    // since C++17, the characters of character pointers. A wrapper, its smart pointer and the raw pointer of one
+    // object are the same key, and so are a not_empty<const char*>, a std::string_view and a std::string of the same
+    // text. Other key types, e.g. not_empty_range, specialize it.
+    template<typename T, typename = void>
+    struct key {
+      static constexpr auto of(const T& value) noexcept -> const T& {
+        return value;
+      }
+    };
+
+    // The stored value of a wrapper as a key. Optionals are never empty in a wrapper, so they are keyed by their value.
+    template<typename T>
+    struct stored_key : key<T> {};
+
+#ifdef __cpp_lib_optional
+    template<typename T>
+    struct stored_key<std::optional<T>> {
+      static constexpr auto of(const std::optional<T>& value) noexcept -> decltype(key<T>::of(*value)) {
+        return key<T>::of(*value);
+      }
+    };
+#endif
+
+    template<typename T>
+    struct key<T, typename std::enable_if<is_not_empty<T>::value>::type> {
+      using stored_type = typename T::stored_type;
+
+      static constexpr auto of(const T& value) noexcept
+      -> decltype(stored_key<stored_type>::of(not_empty_access::stored(value))) {
+        return stored_key<stored_type>::of(not_empty_access::stored(value));
+      }
+    };
+
+#ifdef __cpp_lib_string_view
+    template<>
+    struct key<const char*> {
+      static constexpr auto of(const char* value) noexcept -> std::string_view {
+        return std::string_view(value);
+      }
+    };
+
+    template<>
+    struct key<char*> : key<const char*> {};
+
+    template<std::size_t Size>
+    struct key<char[Size]> : key<const char*> {};
+
+    template<std::size_t Size>
+    struct key<const char[Size]> : key<const char*> {};
+#endif
+
+    template<typename T, typename Deleter>
+    struct key<std::unique_ptr<T, Deleter>> {
+      using pointer = typename std::unique_ptr<T, Deleter>::pointer;
+
+      static auto of(const std::unique_ptr<T, Deleter>& value) noexcept -> pointer {
+        return value.get();
+      }
+    };
+
+    template<typename T>
+    struct key<std::shared_ptr<T>> {
+      static auto of(const std::shared_ptr<T>& value) noexcept -> T* {
+        return value.get();
+      }
+    };
+
+    template<typename T>
+    auto key_of(const T& value) noexcept -> decltype(key<T>::of(value)) {
+      return key<T>::of(value);
+    }
+
+    // Pointers are ordered with std::less, which is a total order even where < on unrelated pointers is not.
+    template<typename T, typename U>
+    auto key_less(T* lhs, U* rhs, int) noexcept -> bool {
+      return std::less<typename std::common_type<T*, U*>::type>()(lhs, rhs);
+    }
+
+    template<typename T, typename U>
+    auto key_less(const T& lhs, const U& rhs, long) noexcept(noexcept(lhs < rhs)) -> bool {
+      return lhs < rhs;
+    }
+  }
+
+  // Comparisons of not_empty values with each other, whatever their error handlers and access policies, and with
+  // values of anything their stored values compare with. The stored values are compared, without an access check.
+#define MILLI_DETAIL_NOT_EMPTY_COMPARISON(op)                                                                          \
+  template<typename T, typename E1, typename P1, typename U, typename E2, typename P2>                                 \
+  constexpr auto operator op(const not_empty_base<T, E1, P1>& lhs, const not_empty_base<U, E2, P2>& rhs)               \
+  noexcept(noexcept(std::declval<const T&>() op std::declval<const U&>()))                                             \
+  -> decltype(std::declval<const T&>() op std::declval<const U&>()) {                                                  \
+    return detail::not_empty_access::stored(lhs) op detail::not_empty_access::stored(rhs);                             \
+  }                                                                                                                    \
+                                                                                                                       \
+  template<typename T, typename E, typename P, typename U, typename = detail::enable_if_not_wrapped<U>>                \
+  constexpr auto operator op(const not_empty_base<T, E, P>& lhs, const U& rhs)                                         \
+  noexcept(noexcept(std::declval<const T&>() op rhs)) -> decltype(std::declval<const T&>() op rhs) {                   \
+    return detail::not_empty_access::stored(lhs) op rhs;                                                               \
+  }                                                                                                                    \
+                                                                                                                       \
+  template<typename U, typename T, typename E, typename P, typename = detail::enable_if_not_wrapped<U>>                \
+  constexpr auto operator op(const U& lhs, const not_empty_base<T, E, P>& rhs)                                         \
+  noexcept(noexcept(lhs op std::declval<const T&>())) -> decltype(lhs op std::declval<const T&>()) {                   \
+    return lhs op detail::not_empty_access::stored(rhs);                                                               \
+  }
+
+  MILLI_DETAIL_NOT_EMPTY_COMPARISON(==)
+  MILLI_DETAIL_NOT_EMPTY_COMPARISON(!=)
+  MILLI_DETAIL_NOT_EMPTY_COMPARISON(<)
+  MILLI_DETAIL_NOT_EMPTY_COMPARISON(<=)
+  MILLI_DETAIL_NOT_EMPTY_COMPARISON(>)
+  MILLI_DETAIL_NOT_EMPTY_COMPARISON(>=)
+
+#undef MILLI_DETAIL_NOT_EMPTY_COMPARISON
+
+  // Transparent function objects for containers of not_empty keys. They hash and compare the stored value, and smart
+  // pointers by their pointer, so a std::unordered_set<not_empty_h<std::shared_ptr<T>>, not_empty_hash,
+  // not_empty_equal_to> is searched with a T* and a std::set<..., not_empty_less> as well, without building a
+  // temporary wrapper or running its check. Heterogeneous lookup in unordered containers needs C++20, in ordered ones
+  // C++14. Since C++17, pointers to characters are keyed by their text, unlike std::hash<const char*>: a set of
+  // not_empty_i<const char*> is searched with a const char*, a std::string_view or a std::string.
+  struct not_empty_hash {
+    using is_transparent = void;
+
+    template<typename T>
+    auto operator()(const T& value) const noexcept(noexcept(std::hash<typename std::decay<
+        decltype(detail::key_of(value))>::type>()(detail::key_of(value)))) -> std::size_t {
+      return std::hash<typename std::decay<decltype(detail::key_of(value))>::type>()(detail::key_of(value));
+    }
+  };
+
+  struct not_empty_equal_to {
+    using is_transparent = void;
+
+    template<typename T, typename U>
+    auto operator()(const T& lhs, const U& rhs) const noexcept(noexcept(detail::key_of(lhs) == detail::key_of(rhs)))
+    -> bool {
+      return detail::key_of(lhs) == detail::key_of(rhs);
+    }
+  };
+
+  struct not_empty_less {
+    using is_transparent = void;
+
+    template<typename T, typename U>
+    auto operator()(const T& lhs, const U& rhs) const
+    noexcept(noexcept(detail::key_less(detail::key_of(lhs), detail::key_of(rhs), 0))) -> bool {
+      return detail::key_less(detail::key_of(lhs), detail::key_of(rhs), 0);
+    }
+  };
+
+  namespace detail {
+
+    // std::hash of the not_empty_X classes: the hash of the stored value, which for smart pointers is that of their
+    // pointer, so the standard hash and not_empty_hash agree.
+    template<typename NotEmpty>
+    struct not_empty_std_hash {
+      auto operator()(const NotEmpty& value) const
+      noexcept(noexcept(not_empty_hash()(value))) -> decltype(not_empty_hash()(value)) {
+        return not_empty_hash()(value);
+      }
+    };
+  }
+}
+
+namespace std {
+  template<typename T, typename ErrorHandler, typename AccessPolicy>
+  struct hash<::milli::not_empty_base<T, ErrorHandler, AccessPolicy>>
+      : ::milli::detail::not_empty_std_hash<::milli::not_empty_base<T, ErrorHandler, AccessPolicy>> {};
 }
 
 #endif //MILLI_LIBRARY_NOT_EMPTY_BASE_HPP
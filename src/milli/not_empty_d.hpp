@@ -17,22 +17,30 @@ not_empty_d.hpp: This file is part of the Milli Library.
 #ifndef MILLI_LIBRARY_NOT_EMPTY_D_HPP
 #define MILLI_LIBRARY_NOT_EMPTY_D_HPP
 
+#include <milli/contract.hpp>
 #include <milli/not_empty.hpp>
-#include <cassert>
 
 namespace milli{
 
   namespace detail{
+    // An ordinary MILLI_ASSERT: checked unless MILLI_CONTRACT_LEVEL is below MILLI_CONTRACT_DEFAULT (by default, when
+    // NDEBUG is defined). Disabled, it is an assumption where contract.hpp makes disabled checks assumptions
+    // (MILLI_CONTRACT_ASSUMES_DISABLED_CHECKS): an empty not_empty_d is then undefined behaviour in release builds, not
+    // just unchecked. Elsewhere nothing is checked or assumed.
     struct debug_error_handler{
       void operator()(bool condition) noexcept {
-        assert(condition);
+        MILLI_ASSERT(condition);
       }
     };
   }
 
-  template <typename T>
-  class not_empty_d : public not_empty_base<T, detail::debug_error_handler>{
-    using not_empty_base<T, detail::debug_error_handler>::not_empty_base;
+  template <typename T, typename AccessPolicy = check_on_access>
+  class not_empty_d : public not_empty_base<T, detail::debug_error_handler, AccessPolicy>{
+    using not_empty_base<T, detail::debug_error_handler, AccessPolicy>::not_empty_base;
+
+  public:
+    using trivially_relocatable = trivially_relocatable_as<not_empty_d, is_trivially_relocatable<T>::value>;
+    using not_empty_base<T, detail::debug_error_handler, AccessPolicy>::operator=;
   };
 
 #ifdef __cpp_deduction_guides
@@ -43,4 +51,10 @@ not_empty_d(T) -> not_empty_d<T>;
 }
 
 
+namespace std {
+  template<typename T, typename AccessPolicy>
+  struct hash<::milli::not_empty_d<T, AccessPolicy>>
+      : ::milli::detail::not_empty_std_hash<::milli::not_empty_d<T, AccessPolicy>> {};
+}
+
 #endif //MILLI_LIBRARY_NOT_EMPTY_D_HPP
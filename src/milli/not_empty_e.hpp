@@ -17,7 +17,9 @@ not_empty_d.hpp: This file is part of the Milli Library.
 #ifndef MILLI_LIBRARY_NOT_EMPTY_E_HPP
 #define MILLI_LIBRARY_NOT_EMPTY_E_HPP
 
+#include <cstddef>
 #include <stdexcept>
+#include <string>
 #include <milli/not_empty.hpp>
 
 namespace milli{
@@ -33,13 +35,23 @@ namespace milli{
           throw value_not_empty("milli::not_empty_e value was empty!");
         }
       }
+
+      void operator()(bool condition, std::size_t index) {
+        if(not condition){
+          throw value_not_empty("milli::not_empty_e element " + std::to_string(index) + " was empty!");
+        }
+      }
     };
   }
 
 
-  template <typename T>
-  class not_empty_e : public not_empty_base<T, detail::exception_error_handler>{
-    using not_empty_base<T, detail::exception_error_handler>::not_empty_base;
+  template <typename T, typename AccessPolicy = check_on_access>
+  class not_empty_e : public not_empty_base<T, detail::exception_error_handler, AccessPolicy>{
+    using not_empty_base<T, detail::exception_error_handler, AccessPolicy>::not_empty_base;
+
+  public:
+    using trivially_relocatable = trivially_relocatable_as<not_empty_e, is_trivially_relocatable<T>::value>;
+    using not_empty_base<T, detail::exception_error_handler, AccessPolicy>::operator=;
   };
 
 #ifdef __cpp_deduction_guides
@@ -48,4 +60,10 @@ not_empty_e(T) -> not_empty_e<T>;
 #endif
 }
 
+namespace std {
+  template<typename T, typename AccessPolicy>
+  struct hash<::milli::not_empty_e<T, AccessPolicy>>
+      : ::milli::detail::not_empty_std_hash<::milli::not_empty_e<T, AccessPolicy>> {};
+}
+
 #endif //MILLI_LIBRARY_NOT_EMPTY_E_HPP
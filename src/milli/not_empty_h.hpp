@@ -17,22 +17,43 @@ not_empty_h.hpp: This file is part of the Milli Library.
 #ifndef MILLI_LIBRARY_NOT_EMPTY_H_HPP
 #define MILLI_LIBRARY_NOT_EMPTY_H_HPP
 
+#include <milli/attributes.hpp>
 #include <milli/not_empty.hpp>
+#include <cstddef>
+#include <cstdio>
 #include <exception>
 #include "strong_assert.hpp"
 
 namespace milli{
   namespace detail{
+    // Formats the index of the empty element and terminates. Kept out of line so the inlined check at each call
+    // site stays a compare and a branch.
+    [[noreturn]] MILLI_COLD inline void empty_element_failure(std::size_t index, const char* location) noexcept {
+      char message[96];
+      std::snprintf(message, sizeof(message), "milli::detail::not_empty_h. Element %lu in not_empty was empty",
+                    static_cast<unsigned long>(index));
+      strong_assert_failure(message, location);
+    }
+
     struct hard_error_handler{
       void operator()(bool condition) noexcept {
         strong_assert(condition, "milli::detail::not_empty_h. Value in not_empty was empty", __PRETTY_FUNCTION__);
       }
+
+      void operator()(bool condition, std::size_t index) noexcept {
+        if(MILLI_UNLIKELY(not condition))
+          empty_element_failure(index, __PRETTY_FUNCTION__);
+      }
     };
   }
 
-  template <typename T>
-  class not_empty_h : public not_empty_base<T, detail::hard_error_handler>{
-    using not_empty_base<T, detail::hard_error_handler>::not_empty_base;
+  template <typename T, typename AccessPolicy = check_on_access>
+  class not_empty_h : public not_empty_base<T, detail::hard_error_handler, AccessPolicy>{
+    using not_empty_base<T, detail::hard_error_handler, AccessPolicy>::not_empty_base;
+
+  public:
+    using trivially_relocatable = trivially_relocatable_as<not_empty_h, is_trivially_relocatable<T>::value>;
+    using not_empty_base<T, detail::hard_error_handler, AccessPolicy>::operator=;
   };
 
 #ifdef __cpp_deduction_guides
@@ -41,4 +62,10 @@ not_empty_h(T) -> not_empty_h<T>;
 #endif
 }
 
+namespace std {
+  template<typename T, typename AccessPolicy>
+  struct hash<::milli::not_empty_h<T, AccessPolicy>>
+      : ::milli::detail::not_empty_std_hash<::milli::not_empty_h<T, AccessPolicy>> {};
+}
+
 #endif //MILLI_LIBRARY_NOT_EMPTY_H_HPP
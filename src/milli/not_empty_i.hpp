@@ -21,9 +21,13 @@ not_empty_i.hpp: This file is part of the Milli Library.
 
 namespace milli { ;
 
-  template<typename T>
-  class not_empty_i : public not_empty_base<T> {
-    using not_empty_base<T>::not_empty_base;
+  template<typename T, typename AccessPolicy = check_on_access>
+  class not_empty_i : public not_empty_base<T, detail::no_error_handler, AccessPolicy> {
+    using not_empty_base<T, detail::no_error_handler, AccessPolicy>::not_empty_base;
+
+  public:
+    using trivially_relocatable = trivially_relocatable_as<not_empty_i, is_trivially_relocatable<T>::value>;
+    using not_empty_base<T, detail::no_error_handler, AccessPolicy>::operator=;
   };
 
 #ifdef __cpp_deduction_guides
@@ -32,4 +36,10 @@ namespace milli { ;
 #endif
 }
 
+namespace std {
+  template<typename T, typename AccessPolicy>
+  struct hash<::milli::not_empty_i<T, AccessPolicy>>
+      : ::milli::detail::not_empty_std_hash<::milli::not_empty_i<T, AccessPolicy>> {};
+}
+
 #endif //MILLI_LIBRARY_NOT_EMPTY_I_HPP
\ No newline at end of file
@@ -0,0 +1,256 @@
+/*
+not_empty_range.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_NOT_EMPTY_RANGE_HPP
+#define MILLI_LIBRARY_NOT_EMPTY_RANGE_HPP
+
+#include <milli/not_empty.hpp>
+#include <milli/not_empty_d.hpp>
+#include <milli/not_empty_e.hpp>
+#include <milli/not_empty_h.hpp>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#if __cplusplus > 201703L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#endif
+#endif
+
+namespace milli {
+
+  namespace detail {
+    struct less {
+      template<typename T, typename U>
+      constexpr auto operator()(const T& lhs, const U& rhs) const noexcept(noexcept(lhs < rhs)) -> bool {
+        return lhs < rhs;
+      }
+    };
+  }
+
+  // Range (container, span, string_view...) that holds at least one element. The size is checked once, at
+  // construction and assignment, with the same error handlers as not_empty_i/d/h/e. Afterwards the accessors below
+  // never test for emptiness. The range can not be shrunk through the wrapper: only its elements are mutable.
+  template<typename Range, typename ErrorHandler = detail::no_error_handler>
+  class not_empty_range {
+  public:
+    using range_type      = Range;
+    using iterator        = decltype(std::begin(std::declval<range_type&>()));
+    using const_iterator  = decltype(std::begin(std::declval<const range_type&>()));
+    using reference       = decltype(*std::declval<iterator>());
+    using const_reference = decltype(*std::declval<const_iterator>());
+    using value_type      = typename std::iterator_traits<iterator>::value_type;
+    using size_type       = std::size_t;
+
+  private:
+    static constexpr bool is_error_check_noexcept = noexcept(std::declval<ErrorHandler>()(false));
+
+    template<typename U>
+    using enable_if_range = typename std::enable_if<
+        std::is_convertible<U, range_type>::value &&
+        not std::is_same<typename std::decay<U>::type, not_empty_range>::value>::type;
+
+  public:
+    not_empty_range() = delete;
+
+    template<typename U, typename = enable_if_range<U>>
+    not_empty_range(U&& range) noexcept(std::is_nothrow_constructible<range_type, U&&>::value && is_error_check_noexcept)
+        : range_(std::forward<U>(range)) {
+      ErrorHandler()(std::begin(range_) != std::end(range_));
+    }
+
+    template<typename U, typename = enable_if_range<U>>
+    auto operator=(U&& range) -> not_empty_range& {
+      range_type checked(std::forward<U>(range));
+      ErrorHandler()(std::begin(checked) != std::end(checked));
+      range_ = std::move(checked);
+      return *this;
+    }
+
+    constexpr auto get() const noexcept -> const range_type& {
+      return range_;
+    }
+
+    constexpr operator const range_type&() const noexcept {
+      return range_;
+    }
+
+    auto begin() noexcept(noexcept(std::begin(std::declval<range_type&>()))) -> iterator {
+      return std::begin(range_);
+    }
+
+    auto end() noexcept(noexcept(std::end(std::declval<range_type&>()))) -> iterator {
+      return std::end(range_);
+    }
+
+    auto begin() const noexcept(noexcept(std::begin(std::declval<const range_type&>()))) -> const_iterator {
+      return std::begin(range_);
+    }
+
+    auto end() const noexcept(noexcept(std::end(std::declval<const range_type&>()))) -> const_iterator {
+      return std::end(range_);
+    }
+
+    auto size() const -> size_type {
+      return static_cast<size_type>(std::distance(begin(), end()));
+    }
+
+    constexpr auto empty() const noexcept -> bool {
+      return false;
+    }
+
+    auto front() -> reference {
+      return *begin();
+    }
+
+    auto front() const -> const_reference {
+      return *begin();
+    }
+
+    auto back() -> reference {
+      return *std::prev(end());
+    }
+
+    auto back() const -> const_reference {
+      return *std::prev(end());
+    }
+
+    auto operator[](size_type index) -> reference {
+      return begin()[static_cast<typename std::iterator_traits<iterator>::difference_type>(index)];
+    }
+
+    auto operator[](size_type index) const -> const_reference {
+      return begin()[static_cast<typename std::iterator_traits<const_iterator>::difference_type>(index)];
+    }
+
+    // Smallest element (first one among equals). Unlike std::min_element there is no end iterator to return,
+    // so the result is always a valid reference.
+    template<typename Compare = detail::less>
+    auto min(Compare compare = Compare()) const -> const_reference {
+      auto current = begin();
+      auto last = end();
+      auto best = current;
+      while (++current != last) {
+        if (compare(*current, *best))
+          best = current;
+      }
+      return *best;
+    }
+
+    // Largest element (first one among equals).
+    template<typename Compare = detail::less>
+    auto max(Compare compare = Compare()) const -> const_reference {
+      auto current = begin();
+      auto last = end();
+      auto best = current;
+      while (++current != last) {
+        if (compare(*best, *current))
+          best = current;
+      }
+      return *best;
+    }
+
+    // Calls callback for every element. The loop is a do-while: the first iteration is known to exist.
+    template<typename Callback>
+    auto for_each(Callback callback) -> Callback {
+      auto current = begin();
+      auto last = end();
+      do {
+        callback(*current);
+      } while (++current != last);
+      return callback;
+    }
+
+    template<typename Callback>
+    auto for_each(Callback callback) const -> Callback {
+      auto current = begin();
+      auto last = end();
+      do {
+        callback(*current);
+      } while (++current != last);
+      return callback;
+    }
+
+    // Equality of the ranges, for ranges that have it, e.g. string views as keys of unordered containers.
+    template<typename R = range_type>
+    friend auto operator==(const not_empty_range& lhs, const not_empty_range& rhs)
+    noexcept(noexcept(std::declval<const R&>() == std::declval<const R&>()))
+    -> decltype(std::declval<const R&>() == std::declval<const R&>()) {
+      return lhs.range_ == rhs.range_;
+    }
+
+    template<typename R = range_type>
+    friend auto operator!=(const not_empty_range& lhs, const not_empty_range& rhs)
+    noexcept(noexcept(std::declval<const R&>() != std::declval<const R&>()))
+    -> decltype(std::declval<const R&>() != std::declval<const R&>()) {
+      return lhs.range_ != rhs.range_;
+    }
+
+  private:
+    range_type range_;
+  };
+
+  template<typename Range>
+  using not_empty_range_i = not_empty_range<Range>;
+
+  template<typename Range>
+  using not_empty_range_d = not_empty_range<Range, detail::debug_error_handler>;
+
+  template<typename Range>
+  using not_empty_range_h = not_empty_range<Range, detail::hard_error_handler>;
+
+  template<typename Range>
+  using not_empty_range_e = not_empty_range<Range, detail::exception_error_handler>;
+
+#ifdef __cpp_lib_string_view
+  using not_empty_string_view = not_empty_range<std::string_view>;
+#endif
+
+#ifdef __cpp_lib_span
+  template<typename T>
+  using not_empty_std_span = not_empty_range<std::span<T>>;
+#endif
+
+#ifdef __cpp_deduction_guides
+  template<typename Range>
+  not_empty_range(Range) -> not_empty_range<Range>;
+#endif
+
+  namespace detail {
+
+    // Keys of transparent containers: a not_empty_string_view is the same key as its std::string_view.
+    template<typename Range, typename ErrorHandler>
+    struct key<not_empty_range<Range, ErrorHandler>> {
+      static constexpr auto of(const not_empty_range<Range, ErrorHandler>& value) noexcept -> const Range& {
+        return value.get();
+      }
+    };
+  }
+
+}
+
+namespace std {
+  template<typename Range, typename ErrorHandler>
+  struct hash<::milli::not_empty_range<Range, ErrorHandler>>
+      : ::milli::detail::not_empty_std_hash<::milli::not_empty_range<Range, ErrorHandler>> {};
+}
+
+#endif //MILLI_LIBRARY_NOT_EMPTY_RANGE_HPP
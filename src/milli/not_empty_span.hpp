@@ -0,0 +1,211 @@
+/*
+not_empty_span.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_NOT_EMPTY_SPAN_HPP
+#define MILLI_LIBRARY_NOT_EMPTY_SPAN_HPP
+
+#include <milli/not_empty.hpp>
+#include <milli/not_empty_d.hpp>
+#include <milli/not_empty_e.hpp>
+#include <milli/not_empty_h.hpp>
+#include <milli/not_empty_i.hpp>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+
+namespace milli {
+
+  namespace detail {
+
+    // Index of the first null pointer in [data, data + size), or size if there is none.
+    // Vectorized with AVX2 or SSE2 when the translation unit is compiled for them, scalar otherwise.
+    template<typename T>
+    auto find_null_scalar(T* const* data, std::size_t first, std::size_t size) noexcept -> std::size_t {
+      for (; first != size; ++first) {
+        if (data[first] == nullptr)
+          return first;
+      }
+      return size;
+    }
+
+#if defined(__AVX2__) && (defined(__x86_64__) || defined(_M_X64))
+
+    template<typename T>
+    auto find_null(T* const* data, std::size_t size) noexcept -> std::size_t {
+      const auto bytes = reinterpret_cast<const char*>(data);
+      const __m256i zero = _mm256_setzero_si256();
+      std::size_t index = 0;
+
+      for (; index + 16 <= size; index += 16) {
+        const char* step = bytes + index * sizeof(T*);
+        __m256i found = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(step)), zero),
+                            _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(step + 32)), zero)),
+            _mm256_or_si256(_mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(step + 64)), zero),
+                            _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(step + 96)), zero)));
+        if (not _mm256_testz_si256(found, found))
+          return find_null_scalar(data, index, index + 16);
+      }
+
+      return find_null_scalar(data, index, size);
+    }
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+    template<typename T>
+    auto null_lanes(const char* bytes, __m128i zero) noexcept -> __m128i {
+      __m128i pointers = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+      if (sizeof(T*) == 8) {
+        // SSE2 has no 64 bit compare: a pointer is null when both of its 32 bit halves are.
+        pointers = _mm_or_si128(pointers, _mm_shuffle_epi32(pointers, _MM_SHUFFLE(2, 3, 0, 1)));
+      }
+      return _mm_cmpeq_epi32(pointers, zero);
+    }
+
+    template<typename T>
+    auto find_null(T* const* data, std::size_t size) noexcept -> std::size_t {
+      constexpr std::size_t per_vector = sizeof(__m128i) / sizeof(T*);
+      constexpr std::size_t per_step = 4 * per_vector;
+      const auto bytes = reinterpret_cast<const char*>(data);
+      const __m128i zero = _mm_setzero_si128();
+      std::size_t index = 0;
+
+      for (; index + per_step <= size; index += per_step) {
+        const char* step = bytes + index * sizeof(T*);
+        __m128i found = _mm_or_si128(_mm_or_si128(null_lanes<T>(step, zero), null_lanes<T>(step + 16, zero)),
+                                     _mm_or_si128(null_lanes<T>(step + 32, zero), null_lanes<T>(step + 48, zero)));
+        if (_mm_movemask_epi8(found))
+          return find_null_scalar(data, index, index + per_step);
+      }
+
+      return find_null_scalar(data, index, size);
+    }
+
+#else
+
+    template<typename T>
+    auto find_null(T* const* data, std::size_t size) noexcept -> std::size_t {
+      return find_null_scalar(data, 0, size);
+    }
+
+#endif
+
+    // Error handlers that can tell which element was empty get its index, the others only the condition.
+    template<typename ErrorHandler>
+    auto report_element(ErrorHandler&& handler, bool condition, std::size_t index, int)
+    noexcept(noexcept(handler(condition, index))) -> decltype(handler(condition, index), void()) {
+      handler(condition, index);
+    }
+
+    template<typename ErrorHandler>
+    auto report_element(ErrorHandler&& handler, bool condition, std::size_t, long)
+    noexcept(noexcept(handler(condition))) -> void {
+      handler(condition);
+    }
+  }
+
+  // Non-owning view over a contiguous array of pointers, none of which is null. The whole array is validated once,
+  // with a single vectorized scan, when the span is created; the first null pointer found is reported to ErrorHandler
+  // together with its index. Element access afterwards is unchecked.
+  template<typename Pointer, typename ErrorHandler = detail::no_error_handler>
+  class not_empty_span {
+    static_assert(std::is_pointer<Pointer>::value, "not_empty_span holds raw pointers only");
+
+  public:
+    using element_type   = Pointer;
+    using value_type     = typename std::remove_cv<Pointer>::type;
+    using size_type      = std::size_t;
+    using iterator       = const Pointer*;
+    using const_iterator = const Pointer*;
+
+  private:
+    static constexpr bool is_error_check_noexcept =
+        noexcept(detail::report_element(std::declval<ErrorHandler>(), false, std::size_t(), 0));
+
+  public:
+    not_empty_span() = delete;
+
+    not_empty_span(const Pointer* data, size_type size) noexcept(is_error_check_noexcept)
+        : data_(data), size_(size) {
+      auto first_null = detail::find_null(data_, size_);
+      detail::report_element(ErrorHandler(), first_null == size_, first_null, 0);
+    }
+
+    template<std::size_t N>
+    not_empty_span(const Pointer (&array)[N]) noexcept(is_error_check_noexcept)
+        : not_empty_span(array, N) {}
+
+    auto data() const noexcept -> const Pointer* {
+      return data_;
+    }
+
+    auto size() const noexcept -> size_type {
+      return size_;
+    }
+
+    auto empty() const noexcept -> bool {
+      return size_ == 0;
+    }
+
+    auto begin() const noexcept -> iterator {
+      return data_;
+    }
+
+    auto end() const noexcept -> iterator {
+      return data_ + size_;
+    }
+
+    auto operator[](size_type index) const noexcept -> Pointer {
+      return data_[index];
+    }
+
+    // Element as a not_empty_i, so that the non-null guarantee keeps travelling without further checks.
+    auto at(size_type index) const noexcept -> not_empty_i<Pointer> {
+      return not_empty_i<Pointer>(data_[index]);
+    }
+
+    auto front() const noexcept -> Pointer {
+      return data_[0];
+    }
+
+    auto back() const noexcept -> Pointer {
+      return data_[size_ - 1];
+    }
+
+  private:
+    const Pointer* data_;
+    size_type size_;
+  };
+
+  template<typename Pointer>
+  using not_empty_span_i = not_empty_span<Pointer>;
+
+  template<typename Pointer>
+  using not_empty_span_d = not_empty_span<Pointer, detail::debug_error_handler>;
+
+  template<typename Pointer>
+  using not_empty_span_h = not_empty_span<Pointer, detail::hard_error_handler>;
+
+  template<typename Pointer>
+  using not_empty_span_e = not_empty_span<Pointer, detail::exception_error_handler>;
+
+}
+
+#endif //MILLI_LIBRARY_NOT_EMPTY_SPAN_HPP
@@ -0,0 +1,249 @@
+/*
+not_empty_t.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_NOT_EMPTY_T_HPP
+#define MILLI_LIBRARY_NOT_EMPTY_T_HPP
+
+#include <milli/attributes.hpp>
+#include <milli/not_empty.hpp>
+#include <milli/source_site.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace milli {
+
+  struct not_empty_violation {
+    source_site site;
+    std::uint64_t count;
+  };
+
+  namespace detail {
+
+    // Violation counters. Every thread that records a violation gets a fixed table of its own, so recording never
+    // takes a lock or writes to memory another thread writes to. Tables are linked into a lock-free list that
+    // snapshot() walks; they are never freed, and a table whose thread exited is reused by the next recording thread,
+    // so counts survive their threads.
+    class violation_registry {
+    public:
+      static constexpr std::size_t sites_per_thread = 64;
+
+      static auto instance() noexcept -> violation_registry& {
+        static violation_registry registry;
+        return registry;
+      }
+
+      // Only the owning thread writes to an entry: plain loads and stores are enough, the atomics let snapshot() read
+      // concurrently. file, function and line are written before used is set and never change afterwards.
+      struct entry {
+        const char* file = nullptr;
+        const char* function = nullptr;
+        unsigned line = 0;
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<bool> used{false};
+      };
+
+      struct thread_table {
+        entry entries[sites_per_thread];
+        std::atomic<std::uint64_t> unattributed{0};
+        std::atomic<bool> owned{true};
+        thread_table* next = nullptr;
+      };
+
+      auto record(const source_site& site) noexcept -> void {
+        thread_table* table = local_table();
+        if (not table) {
+          unattributed_.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+
+        auto hash = (reinterpret_cast<std::uintptr_t>(site.file) >> 3) ^ (site.line * 2654435761u);
+        for (std::size_t probe = 0; probe != sites_per_thread; ++probe) {
+          entry& slot = table->entries[(hash + probe) % sites_per_thread];
+          if (not slot.used.load(std::memory_order_relaxed)) {
+            slot.file = site.file;
+            slot.function = site.function;
+            slot.line = site.line;
+            slot.count.store(1, std::memory_order_relaxed);
+            slot.used.store(true, std::memory_order_release);
+            return;
+          }
+          if (slot.file == site.file && slot.line == site.line) {
+            increment(slot.count);
+            return;
+          }
+        }
+        increment(table->unattributed);
+      }
+
+      // Counts per call site summed over all threads, ordered by file and line.
+      auto snapshot() const -> std::vector<not_empty_violation> {
+        std::vector<not_empty_violation> result;
+        for (auto table = tables_.load(std::memory_order_acquire); table; table = table->next) {
+          for (auto& slot : table->entries) {
+            if (not slot.used.load(std::memory_order_acquire))
+              continue;
+
+            auto same_site = [&slot](const not_empty_violation& violation) {
+              return violation.site.line == slot.line && std::strcmp(violation.site.file, slot.file) == 0;
+            };
+            auto count = slot.count.load(std::memory_order_relaxed);
+            auto known = std::find_if(result.begin(), result.end(), same_site);
+            if (known != result.end())
+              known->count += count;
+            else
+              result.push_back(not_empty_violation{source_site{slot.file, slot.function, slot.line}, count});
+          }
+        }
+
+        std::sort(result.begin(), result.end(), [](const not_empty_violation& lhs, const not_empty_violation& rhs) {
+          auto order = std::strcmp(lhs.site.file, rhs.site.file);
+          return order < 0 || (order == 0 && lhs.site.line < rhs.site.line);
+        });
+        return result;
+      }
+
+      // Violations that did not fit in a thread table or happened while none could be allocated.
+      auto unattributed() const noexcept -> std::uint64_t {
+        std::uint64_t result = unattributed_.load(std::memory_order_relaxed);
+        for (auto table = tables_.load(std::memory_order_acquire); table; table = table->next)
+          result += table->unattributed.load(std::memory_order_relaxed);
+        return result;
+      }
+
+    private:
+      violation_registry() = default;
+
+      static auto increment(std::atomic<std::uint64_t>& counter) noexcept -> void {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+
+      struct table_owner {
+        thread_table* table;
+
+        ~table_owner() {
+          if (table)
+            table->owned.store(false, std::memory_order_release);
+        }
+      };
+
+      auto local_table() noexcept -> thread_table* {
+        static thread_local table_owner owner{acquire_table()};
+        return owner.table;
+      }
+
+      auto acquire_table() noexcept -> thread_table* {
+        for (auto table = tables_.load(std::memory_order_acquire); table; table = table->next) {
+          bool owned = false;
+          if (not table->owned.load(std::memory_order_relaxed) &&
+              table->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+            return table;
+        }
+
+        auto table = new(std::nothrow) thread_table;
+        if (not table)
+          return nullptr;
+        table->next = tables_.load(std::memory_order_relaxed);
+        while (not tables_.compare_exchange_weak(table->next, table, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        return table;
+      }
+
+      std::atomic<thread_table*> tables_{nullptr};
+      std::atomic<std::uint64_t> unattributed_{0};
+    };
+
+    MILLI_COLD inline auto record_violation(const source_site& site) noexcept -> void {
+      violation_registry::instance().record(site);
+    }
+
+    // Records the violation and carries on: the empty value is still stored, so the caller has to cope with it.
+    // Without a violation the cost is one branch that is predicted not taken. Construction reports the site that
+    // created the value; checks on access report the accessor in not_empty.hpp.
+    struct telemetry_error_handler {
+      void operator()(bool condition, const source_site& site = source_site::current()) noexcept {
+        if (not condition)
+          record_violation(site);
+      }
+    };
+  }
+
+  // Access to the violations recorded by not_empty_t.
+  struct not_empty_telemetry {
+    static auto snapshot() -> std::vector<not_empty_violation> {
+      return detail::violation_registry::instance().snapshot();
+    }
+
+    static auto unattributed() noexcept -> std::uint64_t {
+      return detail::violation_registry::instance().unattributed();
+    }
+
+    // Snapshot in the Prometheus text exposition format, as one counter labelled with the call site.
+    static auto prometheus_text() -> std::string {
+      std::string result =
+          "# HELP milli_not_empty_violations_total Values found empty by milli::not_empty_t.\n"
+          "# TYPE milli_not_empty_violations_total counter\n";
+      for (auto& violation : snapshot()) {
+        result += "milli_not_empty_violations_total{file=\"";
+        append_label(result, violation.site.file);
+        result += "\",line=\"" + std::to_string(violation.site.line) + "\",function=\"";
+        append_label(result, violation.site.function);
+        result += "\"} " + std::to_string(violation.count) + "\n";
+      }
+      result += "milli_not_empty_violations_total{file=\"\",line=\"0\",function=\"\"} " +
+                std::to_string(unattributed()) + "\n";
+      return result;
+    }
+
+  private:
+    static auto append_label(std::string& output, const char* value) -> void {
+      for (; *value; ++value) {
+        if (*value == '\\' || *value == '"')
+          output += '\\';
+        if (*value == '\n')
+          output += "\\n";
+        else
+          output += *value;
+      }
+    }
+  };
+
+  template <typename T, typename AccessPolicy = check_on_access>
+  class not_empty_t : public not_empty_base<T, detail::telemetry_error_handler, AccessPolicy>{
+    using not_empty_base<T, detail::telemetry_error_handler, AccessPolicy>::not_empty_base;
+
+  public:
+    using trivially_relocatable = trivially_relocatable_as<not_empty_t, is_trivially_relocatable<T>::value>;
+    using not_empty_base<T, detail::telemetry_error_handler, AccessPolicy>::operator=;
+  };
+
+#ifdef __cpp_deduction_guides
+template<typename T>
+not_empty_t(T) -> not_empty_t<T>;
+#endif
+}
+
+namespace std {
+  template<typename T, typename AccessPolicy>
+  struct hash<::milli::not_empty_t<T, AccessPolicy>>
+      : ::milli::detail::not_empty_std_hash<::milli::not_empty_t<T, AccessPolicy>> {};
+}
+
+#endif //MILLI_LIBRARY_NOT_EMPTY_T_HPP
@@ -17,8 +17,11 @@ optional.hpp: This file is part of the Milli Library.
 #ifndef MILLI_OPTIONAL_HPP
 #define MILLI_OPTIONAL_HPP
 
+#include <milli/relocate.hpp>
 #include <utility>
 #include <cassert>
+#include <new>
+#include <type_traits>
 
 namespace milli{
 
@@ -26,17 +29,35 @@ namespace milli{
 
     template<typename T>
     struct optional{
+      // The storage holds no pointer into itself, so an optional is relocatable whenever its value is.
+      using trivially_relocatable = trivially_relocatable_as<optional, is_trivially_relocatable<T>::value>;
 
-      optional() noexcept : has_value_(false){}
+      // constexpr, so that static objects holding an optional are constant initialized.
+      constexpr optional() noexcept : data_(), has_value_(false){}
 
       optional(T&& value) noexcept(std::is_nothrow_constructible<T, decltype(std::forward<T>(value))>::value){
         new(&data_) T(std::forward<T>(value));
         has_value_ = true;
       }
 
-      optional(optional&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value){
-        new(&data_) T(std::move(rhs.value()));
-        rhs.reset();
+      optional(optional&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) : has_value_(false){
+        if(rhs.has_value_){
+          new(&data_) T(std::move(rhs.value()));
+          rhs.reset();
+          has_value_ = true;
+        }
+      }
+
+      ~optional(){
+        if(has_value_)
+          value().~T();
+      }
+
+      // Constructs the value in place; there must be none yet.
+      template<typename... Args>
+      void emplace(Args&&... args) noexcept(std::is_nothrow_constructible<T, Args&&...>::value){
+        assert(not has_value_);
+        new(&data_) T(std::forward<Args>(args)...);
         has_value_ = true;
       }
 
@@ -52,7 +73,12 @@ namespace milli{
 
       auto value() const noexcept -> const T&{
         assert(has_value_);
-        return const_cast<optional*>(this)->get();
+        return *reinterpret_cast<const T*>(&data_);
+      }
+
+      // Address of the storage whether or not it holds a value, e.g. to copy the bytes of a trivially copyable T.
+      auto address() const noexcept -> const void*{
+        return &data_;
       }
 
       auto empty() noexcept -> bool{
@@ -20,12 +20,16 @@ raii.hpp: This file is part of the Milli Library.
 #include <utility>
 #include <type_traits>
 #include <milli/optional.hpp>
+#include <milli/relocate.hpp>
 
 namespace milli {
 
   template<typename Functor>
   class raii {
   public:
+    using trivially_relocatable =
+        trivially_relocatable_as<raii, is_trivially_relocatable<detail::optional<Functor>>::value>;
+
     raii() = default;
     explicit raii(Functor &&finalizer) noexcept(std::is_nothrow_constructible<detail::optional<Functor>, decltype(std::forward<Functor>(finalizer))>::value)
         : functor_(std::forward<Functor>(finalizer))  {}
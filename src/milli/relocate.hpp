@@ -0,0 +1,111 @@
+/*
+relocate.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_RELOCATE_HPP
+#define MILLI_LIBRARY_RELOCATE_HPP
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace milli {
+
+  // Type of the trivially_relocatable member a class opts in with. It names the class that declares it, so that a class
+  // deriving from it, which may add members that refer to their own address, does not inherit the promise.
+  template<typename Class, bool Relocatable>
+  struct trivially_relocatable_as : std::integral_constant<bool, Relocatable> {
+    using declared_for = Class;
+  };
+
+  namespace detail {
+
+    template<typename T, typename = void>
+    struct declared_relocatable : std::is_trivially_copyable<T> {};
+
+    template<typename T>
+    struct declared_relocatable<T, typename std::enable_if<
+        std::is_same<typename T::trivially_relocatable::declared_for, T>::value>::type>
+        : std::integral_constant<bool, T::trivially_relocatable::value> {};
+
+  }
+
+  // Whether moving a T to new storage and destroying the original is the same as copying its bytes, i.e. no T refers
+  // to its own address. True for trivially copyable types. A class opts in with a member
+  // using trivially_relocatable = trivially_relocatable_as<Class, ...>; classes deriving from it are back to the
+  // default and declare their own. Types that cannot have a member are specialized.
+  template<typename T>
+  struct is_trivially_relocatable : detail::declared_relocatable<T> {};
+
+  template<typename T>
+  struct is_trivially_relocatable<const T> : is_trivially_relocatable<T> {};
+
+  // Every standard library implementation stores a pointer, or two, and nothing that points into the object.
+  template<typename T>
+  struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+  template<typename T>
+  struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+  template<typename T>
+  struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+  namespace detail {
+
+    template<typename T>
+    auto uninitialized_relocate(T* first, T* last, T* result, std::true_type) noexcept -> T* {
+      auto count = static_cast<std::size_t>(last - first);
+      if (count != 0)
+        std::memmove(static_cast<void*>(result), static_cast<const void*>(first), count * sizeof(T));
+      return result + count;
+    }
+
+    template<typename T>
+    auto uninitialized_relocate(T* first, T* last, T* result, std::false_type)
+    noexcept(std::is_nothrow_move_constructible<T>::value) -> T* {
+      for (; first != last; ++first, ++result) {
+        ::new(static_cast<void*>(result)) T(std::move(*first));
+        first->~T();
+      }
+      return result;
+    }
+
+  }
+
+  // Moves the objects of [first, last) into the uninitialized storage at result and ends their lifetime at the source,
+  // as a move construction followed by a destruction each would. Trivially relocatable objects are moved with one
+  // memmove. The ranges may overlap if result comes before first, e.g. to close the gap of an erased element. Returns
+  // the end of the relocated range. If a move constructor throws, the objects relocated so far stay at the
+  // destination and the others at the source.
+  template<typename T>
+  auto uninitialized_relocate(T* first, T* last, T* result)
+  noexcept(is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value) -> T* {
+    return detail::uninitialized_relocate(first, last, result,
+                                          std::integral_constant<bool, is_trivially_relocatable<T>::value>());
+  }
+
+  // Relocates a single object from source to the uninitialized storage at destination.
+  template<typename T>
+  auto relocate(T* source, T* destination)
+  noexcept(is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value) -> T* {
+    uninitialized_relocate(source, source + 1, destination);
+    return destination;
+  }
+
+}
+
+#endif //MILLI_LIBRARY_RELOCATE_HPP
@@ -0,0 +1,51 @@
+/*
+source_site.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_SOURCE_SITE_HPP
+#define MILLI_SOURCE_SITE_HPP
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_FILE) && __has_builtin(__builtin_FUNCTION) && __has_builtin(__builtin_LINE)
+#define MILLI_HAS_BUILTIN_SOURCE_SITE
+#endif
+#elif (defined(__GNUC__) && __GNUC__ >= 5) || (defined(_MSC_VER) && _MSC_VER >= 1926)
+#define MILLI_HAS_BUILTIN_SOURCE_SITE
+#endif
+
+namespace milli {
+
+  // Source location usable since C++11. Taken as a defaulted source_site::current() parameter it names the place that
+  // called the function, not the function itself. Without compiler support the file is "unknown" and the line 0.
+  struct source_site {
+    const char* file;
+    const char* function;
+    unsigned line;
+
+#ifdef MILLI_HAS_BUILTIN_SOURCE_SITE
+    static constexpr auto current(const char* file = __builtin_FILE(), const char* function = __builtin_FUNCTION(),
+                                  unsigned line = __builtin_LINE()) noexcept -> source_site {
+      return source_site{file, function, line};
+    }
+#else
+    static constexpr auto current() noexcept -> source_site {
+      return source_site{"unknown", "unknown", 0};
+    }
+#endif
+  };
+
+}
+
+#endif //MILLI_SOURCE_SITE_HPP
@@ -1,7 +1,7 @@
 /*
 strong_assert.hpp: This file is part of the Milli Library.
 
-    Copyright (C) Dawid Pilarski, PanicSoftware 2018-2019
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
     Distributed under the BSD 3-clause License.
     (See Milli/LICENSE)
 
@@ -17,22 +17,28 @@ strong_assert.hpp: This file is part of the Milli Library.
 #ifndef MILLI_STRONG_ASSERT_HPP
 #define MILLI_STRONG_ASSERT_HPP
 
-#include <iostream>
-#include <exception>
+#include <milli/attributes.hpp>
+
+#ifndef MILLI_RUNTIME_LIBRARY
+#include <milli/strong_assert_failure.hpp>
+#endif
 
 namespace milli{
 
-static void strong_assert(bool condition, const char* message = nullptr, const char* error_location = nullptr) noexcept {
-  if(not condition){
-    if(error_location)
-      std::cerr << error_location << " :=> ";
-    if(message)
-      std::cerr << message;
+#ifdef MILLI_RUNTIME_LIBRARY
+
+namespace detail{
+
+// Writes "error_location :=> message" to stderr and terminates; defined in the milli_runtime library.
+[[noreturn]] MILLI_COLD void strong_assert_failure(const char* message, const char* error_location) noexcept;
+
+}
 
-    std::cerr << std::endl;
+#endif
 
-    std::terminate();
-  }
+inline void strong_assert(bool condition, const char* message = nullptr, const char* error_location = nullptr) noexcept {
+  if(MILLI_UNLIKELY(not condition))
+    detail::strong_assert_failure(message, error_location);
 }
 
 }
@@ -0,0 +1,84 @@
+/*
+strong_assert_failure.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_STRONG_ASSERT_FAILURE_HPP
+#define MILLI_STRONG_ASSERT_FAILURE_HPP
+
+#include <milli/attributes.hpp>
+#include <milli/failure_hook.hpp>
+#include <cstddef>
+#include <exception>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Header only builds define the failure path inline; the milli_runtime library compiles it once, with
+// MILLI_RUNTIME_INLINE defined empty.
+#ifndef MILLI_RUNTIME_INLINE
+#define MILLI_RUNTIME_INLINE inline
+#endif
+
+namespace milli{
+
+namespace detail{
+
+  MILLI_RUNTIME_INLINE auto append_text(char* buffer, std::size_t size, std::size_t used, const char* text) noexcept -> std::size_t {
+    for(; text && *text && used < size; ++text)
+      buffer[used++] = *text;
+    return used;
+  }
+
+  MILLI_RUNTIME_INLINE auto write_stderr(const char* data, std::size_t size) noexcept -> void {
+    while(size != 0){
+#if defined(_WIN32)
+      auto written = _write(2, data, static_cast<unsigned>(size));
+#else
+      auto written = ::write(2, data, size);
+#endif
+      if(written <= 0)
+        return;
+      data += written;
+      size -= static_cast<std::size_t>(written);
+    }
+  }
+
+  // Writes "error_location :=> message" to stderr, runs the failure hook and terminates. Async-signal-safe up to
+  // std::terminate: the text is formatted into a stack buffer and written with write(2), nothing is allocated.
+  [[noreturn]] MILLI_COLD MILLI_RUNTIME_INLINE void strong_assert_failure(const char* message, const char* error_location) noexcept {
+    char buffer[1024];
+    const std::size_t capacity = sizeof(buffer) - 1;
+    std::size_t used = 0;
+
+    if(error_location){
+      used = append_text(buffer, capacity, used, error_location);
+      used = append_text(buffer, capacity, used, " :=> ");
+    }
+    used = append_text(buffer, capacity, used, message);
+    buffer[used++] = '\n';
+    write_stderr(buffer, used);
+
+    run_failure_hook();
+    std::terminate();
+  }
+
+}
+
+}
+
+#endif //MILLI_STRONG_ASSERT_FAILURE_HPP
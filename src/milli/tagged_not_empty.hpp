@@ -0,0 +1,194 @@
+/*
+tagged_not_empty.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_TAGGED_NOT_EMPTY_HPP
+#define MILLI_LIBRARY_TAGGED_NOT_EMPTY_HPP
+
+#include <milli/not_empty.hpp>
+#include <milli/not_empty_d.hpp>
+#include <milli/not_empty_e.hpp>
+#include <milli/not_empty_h.hpp>
+#include <milli/not_empty_i.hpp>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Number of most significant pointer bits that are always zero for user space addresses and may carry tags. 64 bit x86
+// and ARM use 48 bit virtual addresses; define it to a smaller value for systems with larger address spaces.
+#ifndef MILLI_TAGGED_POINTER_HIGH_BITS
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(_M_ARM64)
+#define MILLI_TAGGED_POINTER_HIGH_BITS 16
+#else
+#define MILLI_TAGGED_POINTER_HIGH_BITS 0
+#endif
+#endif
+
+namespace milli {
+
+  namespace detail {
+
+    constexpr auto log2_floor(std::size_t value) noexcept -> unsigned {
+      return value < 2 ? 0 : 1 + log2_floor(value / 2);
+    }
+
+    // Where Bits bits of tag go in a pointer to T: as many as the alignment of T allows into the low bits, the rest
+    // into the high bits. Only instantiated from member functions, so that T may still be incomplete where a
+    // tagged_not_empty<T*, Bits> member is declared.
+    template<typename T, unsigned Bits>
+    struct tag_layout {
+      static constexpr unsigned alignment_bits = log2_floor(alignof(T));
+      static constexpr unsigned low = Bits < alignment_bits ? Bits : alignment_bits;
+      static constexpr unsigned high = Bits - low;
+
+      static_assert(high <= MILLI_TAGGED_POINTER_HIGH_BITS, "more tag bits requested than the pointer has spare");
+
+      static constexpr unsigned high_shift = high == 0 ? 0 : sizeof(std::uintptr_t) * CHAR_BIT - high;
+      static constexpr std::uintptr_t low_mask = (std::uintptr_t(1) << low) - 1;
+      static constexpr std::uintptr_t high_mask = high == 0 ? 0 : ~std::uintptr_t(0) << high_shift;
+      static constexpr std::uintptr_t tag_mask = low_mask | high_mask;
+
+      static auto pack(std::uintptr_t pointer, std::uintptr_t tag) noexcept -> std::uintptr_t {
+        return pointer | (tag & low_mask) | ((tag >> low) << high_shift);
+      }
+
+      static auto tag(std::uintptr_t word) noexcept -> std::uintptr_t {
+        return (word & low_mask) | ((word & high_mask) >> high_shift << low);
+      }
+    };
+  }
+
+  // Non-null pointer and a small tag in one word. Pointer is T*; the tag uses the low bits that the alignment of T
+  // keeps zero and, if Bits needs more, the unused high bits of the address. Tag is any integer or enum type whose
+  // values fit in Bits bits.
+  //
+  // The error handler checks the pointer on construction and, depending on AccessPolicy, again after the tag has been
+  // stripped on each access, exactly like not_empty_base does. bits() and from_bits() expose the packed word, e.g.
+  // for compare-and-swap on a std::atomic<std::uintptr_t>.
+  template<typename Pointer, unsigned Bits, typename Tag = std::uintptr_t,
+      typename ErrorHandler = detail::no_error_handler, typename AccessPolicy = check_on_access>
+  class tagged_not_empty {
+    static_assert(std::is_pointer<Pointer>::value, "tagged_not_empty packs tags into raw pointers only");
+
+  public:
+    using stored_type  = Pointer;
+    using element_type = typename std::remove_pointer<Pointer>::type;
+    using tag_type     = Tag;
+
+  private:
+    using layout = detail::tag_layout<element_type, Bits>;
+    using access_check = detail::access_check<ErrorHandler, AccessPolicy>;
+    static constexpr bool is_error_check_noexcept = noexcept(std::declval<ErrorHandler>()(false));
+    static constexpr bool is_cpp14_error_check_noexcept =
+#if __cpp_constexpr >= 201304
+        access_check::is_noexcept
+#else
+    true
+#endif
+    ;
+
+  public:
+    tagged_not_empty() = delete;
+
+    tagged_not_empty(Pointer pointer, Tag tag = Tag()) noexcept(is_error_check_noexcept)
+        : word_(pack(pointer, tag)) {
+      ErrorHandler()(pointer != nullptr);
+    }
+
+    tagged_not_empty(std::nullptr_t, Tag = Tag()) = delete;
+
+    // Restores a word obtained from bits(). The stripped pointer goes through the error handler again.
+    static auto from_bits(std::uintptr_t word) noexcept(is_error_check_noexcept) -> tagged_not_empty {
+      tagged_not_empty result(word);
+      ErrorHandler()(result.pointer() != nullptr);
+      return result;
+    }
+
+    auto get() const noexcept(is_cpp14_error_check_noexcept) -> Pointer {
+      Pointer result = pointer();
+#if __cpp_constexpr >= 201304
+      access_check::check(result != nullptr);
+#endif
+      return result;
+    }
+
+    auto operator*() const noexcept(is_cpp14_error_check_noexcept) -> element_type& {
+      return *get();
+    }
+
+    auto operator->() const noexcept(is_cpp14_error_check_noexcept) -> Pointer {
+      return get();
+    }
+
+    auto tag() const noexcept -> Tag {
+      return static_cast<Tag>(layout::tag(word_));
+    }
+
+    auto set_tag(Tag tag) noexcept -> void {
+      word_ = pack(pointer(), tag);
+    }
+
+    auto reset(Pointer pointer, Tag tag = Tag()) noexcept(is_error_check_noexcept) -> void {
+      ErrorHandler()(pointer != nullptr);
+      word_ = pack(pointer, tag);
+    }
+
+    auto bits() const noexcept -> std::uintptr_t {
+      return word_;
+    }
+
+    friend auto operator==(const tagged_not_empty& lhs, const tagged_not_empty& rhs) noexcept -> bool {
+      return lhs.word_ == rhs.word_;
+    }
+
+    friend auto operator!=(const tagged_not_empty& lhs, const tagged_not_empty& rhs) noexcept -> bool {
+      return lhs.word_ != rhs.word_;
+    }
+
+  private:
+    explicit tagged_not_empty(std::uintptr_t word) noexcept : word_(word) {}
+
+    static auto pack(Pointer pointer, Tag tag) noexcept -> std::uintptr_t {
+      auto address = reinterpret_cast<std::uintptr_t>(pointer);
+      auto value = static_cast<std::uintptr_t>(tag);
+      assert((address & layout::tag_mask) == 0 && "pointer is misaligned or outside of the tagged address space");
+      assert((Bits >= sizeof(std::uintptr_t) * CHAR_BIT || value >> Bits == 0) && "tag does not fit in Bits bits");
+      return layout::pack(address, value);
+    }
+
+    auto pointer() const noexcept -> Pointer {
+      return reinterpret_cast<Pointer>(word_ & ~layout::tag_mask);
+    }
+
+    std::uintptr_t word_;
+  };
+
+  template<typename Pointer, unsigned Bits, typename Tag = std::uintptr_t>
+  using tagged_not_empty_i = tagged_not_empty<Pointer, Bits, Tag>;
+
+  template<typename Pointer, unsigned Bits, typename Tag = std::uintptr_t>
+  using tagged_not_empty_d = tagged_not_empty<Pointer, Bits, Tag, detail::debug_error_handler>;
+
+  template<typename Pointer, unsigned Bits, typename Tag = std::uintptr_t>
+  using tagged_not_empty_h = tagged_not_empty<Pointer, Bits, Tag, detail::hard_error_handler>;
+
+  template<typename Pointer, unsigned Bits, typename Tag = std::uintptr_t>
+  using tagged_not_empty_e = tagged_not_empty<Pointer, Bits, Tag, detail::exception_error_handler>;
+
+}
+
+#endif //MILLI_LIBRARY_TAGGED_NOT_EMPTY_HPP
@@ -0,0 +1,92 @@
+/*
+tick_clock.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_TICK_CLOCK_HPP
+#define MILLI_TICK_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MILLI_DETAIL_TICKS_ARE_CYCLES
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define MILLI_DETAIL_TICKS_ARE_CYCLES
+#endif
+
+namespace milli {
+
+  namespace detail {
+
+    inline auto steady_nanoseconds() noexcept -> std::uint64_t {
+      return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Timestamps for the hot paths: cycle counter ticks where reading the counter is one instruction, steady clock
+    // nanoseconds elsewhere. tick_clock_kind tells which, e.g. in files that are decoded on another machine.
+#ifdef MILLI_DETAIL_TICKS_ARE_CYCLES
+    constexpr std::uint32_t tick_clock_kind = 0;
+
+    inline auto read_ticks() noexcept -> std::uint64_t {
+      return __rdtsc();
+    }
+#else
+    constexpr std::uint32_t tick_clock_kind = 1;
+
+    inline auto read_ticks() noexcept -> std::uint64_t {
+      return steady_nanoseconds();
+    }
+#endif
+
+    inline auto tick_clock_unit(std::uint32_t kind) noexcept -> const char* {
+      return kind == 0 ? "ticks" : "ns";
+    }
+
+    // Both clocks at the first call. Touch it early, so that calibration later has a long interval to measure.
+    struct tick_origin {
+      std::uint64_t ticks;
+      std::uint64_t nanoseconds;
+
+      static auto get() noexcept -> const tick_origin& {
+        static const tick_origin origin{read_ticks(), steady_nanoseconds()};
+        return origin;
+      }
+    };
+
+    // Length of a tick, measured against the steady clock since tick_origin::get() was first called. Waits until that
+    // is at least 10 ms ago, so the first call may block for as long.
+    inline auto nanoseconds_per_tick() -> double {
+      if (tick_clock_kind != 0)
+        return 1.0;
+
+      const tick_origin& origin = tick_origin::get();
+      for (;;) {
+        auto ticks = read_ticks();
+        auto nanoseconds = steady_nanoseconds();
+        if (nanoseconds - origin.nanoseconds >= 10000000 && ticks > origin.ticks)
+          return static_cast<double>(nanoseconds - origin.nanoseconds) / static_cast<double>(ticks - origin.ticks);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+  }
+
+}
+
+#endif //MILLI_TICK_CLOCK_HPP
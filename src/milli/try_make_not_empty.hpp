@@ -0,0 +1,49 @@
+/*
+try_make_not_empty.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_LIBRARY_TRY_MAKE_NOT_EMPTY_HPP
+#define MILLI_LIBRARY_TRY_MAKE_NOT_EMPTY_HPP
+
+#include <milli/expected.hpp>
+#include <milli/not_empty_i.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace milli {
+
+  enum class not_empty_error {
+    empty_value
+  };
+
+  template<typename T>
+  using not_empty_result = expected<not_empty_i<T>, not_empty_error>;
+
+  // Non-throwing counterpart of constructing a not_empty_e: an empty value yields not_empty_error::empty_value
+  // instead of an exception. T defaults to the decayed type of the argument.
+  template<typename T = void, typename U,
+      typename Stored = typename std::conditional<std::is_void<T>::value, typename std::decay<U>::type, T>::type>
+  auto try_make_not_empty(U&& value)
+  noexcept(std::is_nothrow_constructible<Stored, U&&>::value && std::is_nothrow_move_constructible<Stored>::value)
+  -> not_empty_result<Stored> {
+    Stored converted(std::forward<U>(value));
+    if (not static_cast<bool>(converted))
+      return make_unexpected(not_empty_error::empty_value);
+    return not_empty_i<Stored>(std::move(converted));
+  }
+
+}
+
+#endif //MILLI_LIBRARY_TRY_MAKE_NOT_EMPTY_HPP
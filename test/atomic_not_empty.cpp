@@ -0,0 +1,145 @@
+/*
+atomic_not_empty.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/atomic_not_empty.hpp>
+#include <milli/not_empty_e.hpp>
+
+#define BOOST_TEST_MODULE atomic_not_empty test
+#include <boost/test/included/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace milli;
+
+namespace {
+
+  struct config {
+    static std::atomic<int> alive;
+
+    explicit config(int version) : version(version), copy(version) { ++alive; }
+    ~config() { --alive; }
+
+    int version;
+    int copy;
+  };
+
+  std::atomic<int> config::alive(0);
+
+  using checked_config = atomic_not_empty<config, detail::exception_error_handler>;
+
+}
+
+BOOST_AUTO_TEST_SUITE(atomic_not_empty_test_suite)
+
+  BOOST_AUTO_TEST_CASE(empty_initial_value_fails) {
+    BOOST_CHECK_THROW(checked_config test(nullptr), milli::value_not_empty);
+  }
+
+  BOOST_AUTO_TEST_CASE(read_current_value) {
+    {
+      checked_config test(std::unique_ptr<config>(new config(1)));
+      auto guard = test.read();
+
+      BOOST_TEST(guard->version == 1);
+      BOOST_TEST((*guard).version == 1);
+      BOOST_TEST(guard.get()->version == 1);
+    }
+    BOOST_TEST(config::alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(empty_store_fails_and_keeps_value) {
+    checked_config test(std::unique_ptr<config>(new config(1)));
+
+    BOOST_CHECK_THROW(test.store(nullptr), milli::value_not_empty);
+    BOOST_TEST(test.read()->version == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(store_defers_reclamation_while_read) {
+    {
+      checked_config test(std::unique_ptr<config>(new config(1)));
+      {
+        auto guard = test.read();
+        test.store(std::unique_ptr<config>(new config(2)));
+
+        BOOST_TEST(guard->version == 1);
+        BOOST_TEST(config::alive == 2);
+        BOOST_TEST(test.reclaim() == 1u);
+      }
+
+      BOOST_TEST(test.reclaim() == 0u);
+      BOOST_TEST(config::alive == 1);
+      BOOST_TEST(test.read()->version == 2);
+    }
+    BOOST_TEST(config::alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(exchange_returns_previous) {
+    checked_config test(std::unique_ptr<config>(new config(1)));
+    auto previous = test.exchange(std::unique_ptr<config>(new config(2)));
+
+    BOOST_TEST(previous->version == 1);
+    BOOST_TEST(test.read()->version == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(nested_reads) {
+    checked_config test(std::unique_ptr<config>(new config(1)));
+    {
+      auto outer = test.read();
+      {
+        auto inner = test.read();
+      }
+      test.store(std::unique_ptr<config>(new config(2)));
+      BOOST_TEST(test.reclaim() == 1u);
+      BOOST_TEST(outer->version == 1);
+    }
+    BOOST_TEST(test.reclaim() == 0u);
+  }
+
+  BOOST_AUTO_TEST_CASE(concurrent_readers_and_writer) {
+    {
+      atomic_not_empty<config> test(std::unique_ptr<config>(new config(0)));
+      std::atomic<bool> done(false);
+      std::atomic<bool> consistent(true);
+
+      std::vector<std::thread> readers;
+      for(int i = 0; i < 3; ++i){
+        readers.emplace_back([&]{
+          int last_seen = 0;
+          while(not done.load()){
+            auto guard = test.read();
+            if(guard->version != guard->copy || guard->version < last_seen)
+              consistent = false;
+            last_seen = guard->version;
+          }
+        });
+      }
+
+      for(int version = 1; version <= 2000; ++version)
+        test.store(std::unique_ptr<config>(new config(version)));
+      done = true;
+
+      for(auto& reader : readers)
+        reader.join();
+
+      BOOST_TEST(consistent.load());
+      BOOST_TEST(test.read()->version == 2000);
+    }
+    BOOST_TEST(config::alive == 0);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
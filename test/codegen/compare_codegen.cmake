@@ -0,0 +1,158 @@
+# Compiles SOURCE to assembly and checks that the functions in every pair of EQUAL ("function=baseline", pairs
+# separated by commas) consist of the same number of instructions and make the same number of calls, and that none of
+# them has a cold part. ALLOWED whitelists known differences: "function=instructions" lets the instruction count of
+# function differ from its baseline by up to that many. On failure both bodies are written side by side to
+# OUTPUT.diff and printed.
+#
+# Expected variables: COMPILER, STANDARD, SOURCE, INCLUDE_DIR, OUTPUT, EQUAL and optionally DEFINITIONS and ALLOWED
+# (separated by commas).
+
+string(REPLACE "," ";" definitions "${DEFINITIONS}")
+set(flags "")
+foreach(definition ${definitions})
+    list(APPEND flags "-D${definition}")
+endforeach()
+
+execute_process(COMMAND ${COMPILER} -std=c++${STANDARD} -O2 -S -fno-asynchronous-unwind-tables -I${INCLUDE_DIR} ${flags}
+                        ${SOURCE} -o ${OUTPUT}
+                RESULT_VARIABLE result
+                ERROR_VARIABLE errors)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Compiling ${SOURCE} failed:\n${errors}")
+endif()
+
+file(STRINGS ${OUTPUT} assembly)
+
+# Instructions between the label of function and the end of its body, with whitespace collapsed and local labels
+# renamed to .L, so that the bodies of two functions can be compared line by line. Calls are call instructions and
+# jumps to anything but a local label, i.e. tail calls.
+function(read_function function instructions_result calls_result)
+    set(inside FALSE)
+    set(instructions "")
+    set(calls 0)
+    foreach(line IN LISTS assembly)
+        if(line STREQUAL "${function}:")
+            set(inside TRUE)
+        elseif(inside)
+            if(line MATCHES "^[\t ]*\\.size[\t ]" OR line MATCHES "^[^\t .][^:]*:$")
+                break()
+            elseif(line MATCHES "^[\t ]+[a-z]" AND NOT line MATCHES "^[\t ]+\\.")
+                string(STRIP "${line}" instruction)
+                string(REGEX REPLACE "[\t ]+" " " instruction "${instruction}")
+                string(REGEX REPLACE "\\.L[A-Za-z_]*[0-9_]+" ".L" instruction "${instruction}")
+                string(REPLACE ";" "," instruction "${instruction}")
+                list(APPEND instructions "${instruction}")
+                if(instruction MATCHES "^call" OR (instruction MATCHES "^(jmp|b|bl) " AND NOT instruction MATCHES " \\.L$"))
+                    math(EXPR calls "${calls} + 1")
+                endif()
+            endif()
+        endif()
+    endforeach()
+    if(NOT inside)
+        message(FATAL_ERROR "Function ${function} not found in the assembly of ${SOURCE}")
+    endif()
+    set(${instructions_result} "${instructions}" PARENT_SCOPE)
+    set(${calls_result} ${calls} PARENT_SCOPE)
+endfunction()
+
+# Both bodies in two columns, lines that differ marked with a '|'.
+function(side_by_side function function_body baseline baseline_body result)
+    list(LENGTH function_body function_length)
+    list(LENGTH baseline_body baseline_length)
+    set(length ${function_length})
+    if(baseline_length GREATER length)
+        set(length ${baseline_length})
+    endif()
+
+    set(width 40)
+    set(padding "                                        ")
+    string(LENGTH "${function}" function_name_length)
+    math(EXPR spaces "${width} - ${function_name_length}")
+    if(spaces LESS 1)
+        set(spaces 1)
+    endif()
+    string(SUBSTRING "${padding}" 0 ${spaces} gap)
+    set(report "${function}${gap}  ${baseline}\n")
+
+    set(index 0)
+    while(index LESS length)
+        set(left "")
+        set(right "")
+        if(index LESS function_length)
+            list(GET function_body ${index} left)
+        endif()
+        if(index LESS baseline_length)
+            list(GET baseline_body ${index} right)
+        endif()
+        set(marker " ")
+        if(NOT left STREQUAL right)
+            set(marker "|")
+        endif()
+        string(LENGTH "${left}" left_length)
+        math(EXPR spaces "${width} - ${left_length}")
+        if(spaces LESS 1)
+            set(spaces 1)
+        endif()
+        string(SUBSTRING "${padding}" 0 ${spaces} gap)
+        string(APPEND report "${left}${gap}${marker} ${right}\n")
+        math(EXPR index "${index} + 1")
+    endwhile()
+    set(${result} "${report}" PARENT_SCOPE)
+endfunction()
+
+string(REPLACE "," ";" allowances "${ALLOWED}")
+
+string(REPLACE "," ";" pairs "${EQUAL}")
+set(failed FALSE)
+set(report "")
+foreach(pair ${pairs})
+    string(REPLACE "=" ";" functions "${pair}")
+    list(GET functions 0 function)
+    list(GET functions 1 baseline)
+    read_function(${function} function_body function_calls)
+    read_function(${baseline} baseline_body baseline_calls)
+    list(LENGTH function_body function_count)
+    list(LENGTH baseline_body baseline_count)
+
+    set(allowed 0)
+    foreach(allowance ${allowances})
+        if(allowance MATCHES "^${function}=([0-9]+)$")
+            set(allowed ${CMAKE_MATCH_1})
+        endif()
+    endforeach()
+    math(EXPR difference "${function_count} - ${baseline_count}")
+    if(difference LESS 0)
+        math(EXPR difference "-${difference}")
+    endif()
+
+    set(problem "")
+    if(difference GREATER allowed)
+        set(problem "${function}: ${function_count} instructions, ${baseline}: ${baseline_count}")
+        if(allowed GREATER 0)
+            string(APPEND problem " (${allowed} allowed)")
+        endif()
+    elseif(NOT function_calls EQUAL baseline_calls)
+        set(problem "${function}: ${function_calls} calls, ${baseline}: ${baseline_calls}")
+    elseif(";${assembly};" MATCHES ";${function}\\.cold:")
+        set(problem "${function} has a cold part")
+    endif()
+
+    if(problem)
+        message(SEND_ERROR "${problem}")
+        side_by_side(${function} "${function_body}" ${baseline} "${baseline_body}" listing)
+        string(APPEND report "${problem}\n${listing}\n")
+        set(failed TRUE)
+    elseif(difference EQUAL 0)
+        message(STATUS "${function}: ${function_count} instructions and ${function_calls} calls, same as ${baseline}")
+    else()
+        message(STATUS "${function}: ${function_count} instructions, ${baseline}: ${baseline_count}, "
+                       "within the ${allowed} allowed")
+    endif()
+endforeach()
+
+if(failed)
+    file(WRITE ${OUTPUT}.diff "${report}")
+    message("\n${report}")
+    message(FATAL_ERROR "Code generation differs in ${SOURCE} with ${COMPILER} -std=c++${STANDARD}, see ${OUTPUT} "
+                        "and ${OUTPUT}.diff")
+endif()
@@ -0,0 +1,70 @@
+/*
+contract_off.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// Compiled with MILLI_CONTRACT_LEVEL=MILLI_CONTRACT_OFF: every function below has to compile to exactly the instructions
+// of its baseline, disabled checks leave nothing behind.
+
+#include <milli/contract.hpp>
+#include <algorithm>
+#include <cstddef>
+
+extern "C" int baseline_load(const int* pointer) {
+  return *pointer;
+}
+
+extern "C" int disabled_hot(const int* pointer) {
+  MILLI_EXPECTS_HOT(pointer != nullptr);
+  return *pointer;
+}
+
+extern "C" int disabled_default(const int* pointer) {
+  MILLI_ASSERT(pointer != nullptr);
+  return *pointer;
+}
+
+// Functions called in a disabled condition are not called, like in a disabled assert.
+extern "C" bool validate(const int* pointer);
+
+extern "C" int disabled_call(const int* pointer) {
+  MILLI_ASSERT(validate(pointer));
+  return *pointer;
+}
+
+// Where disabled checks are assumptions, the optimizer drops the null check the function makes on its own. Elsewhere
+// the check stays.
+#ifdef MILLI_CONTRACT_ASSUMES_DISABLED_CHECKS
+extern "C" int baseline_assumed(const int* pointer) {
+  return *pointer;
+}
+#else
+extern "C" int baseline_assumed(const int* pointer) {
+  return pointer ? *pointer : -1;
+}
+#endif
+
+extern "C" int assumed_not_null(const int* pointer) {
+  MILLI_EXPECTS(pointer != nullptr);
+  return pointer ? *pointer : -1;
+}
+
+extern "C" int baseline_first(const int* data, std::size_t size) {
+  return size ? data[0] : 0;
+}
+
+extern "C" int disabled_audit(const int* data, std::size_t size) {
+  MILLI_EXPECTS_AUDIT(std::is_sorted(data, data + size));
+  return size ? data[0] : 0;
+}
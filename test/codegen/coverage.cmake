@@ -0,0 +1,36 @@
+# Checks that every header in HEADER_DIR is included by one of the code generation sources in CODEGEN_DIR, or listed in
+# EXEMPT (separated by commas), so that no header escapes the zero overhead checks by being forgotten.
+#
+# Expected variables: HEADER_DIR, CODEGEN_DIR and optionally EXEMPT.
+
+file(GLOB headers RELATIVE ${HEADER_DIR} ${HEADER_DIR}/*.hpp)
+file(GLOB sources ${CODEGEN_DIR}/*.cpp)
+if(NOT headers OR NOT sources)
+    message(FATAL_ERROR "No headers in ${HEADER_DIR} or no sources in ${CODEGEN_DIR}")
+endif()
+string(REPLACE "," ";" exempt "${EXEMPT}")
+
+set(included "")
+foreach(source ${sources})
+    file(STRINGS ${source} includes REGEX "^#include <milli/[^>]+>")
+    foreach(line ${includes})
+        string(REGEX REPLACE "^#include <milli/([^>]+)>.*" "\\1" header "${line}")
+        list(APPEND included ${header})
+    endforeach()
+endforeach()
+
+set(missing "")
+foreach(header ${headers})
+    list(FIND included ${header} included_index)
+    list(FIND exempt ${header} exempt_index)
+    if(included_index EQUAL -1 AND exempt_index EQUAL -1)
+        list(APPEND missing ${header})
+    elseif(NOT included_index EQUAL -1 AND NOT exempt_index EQUAL -1)
+        message(SEND_ERROR "${header} is checked by a code generation test and needs no exemption")
+    endif()
+endforeach()
+
+if(missing)
+    string(REPLACE ";" ", " missing "${missing}")
+    message(FATAL_ERROR "Headers without a code generation test or an exemption: ${missing}")
+endif()
@@ -0,0 +1,38 @@
+/*
+profiler_off.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// Compiled with MILLI_PROFILER_DISABLED: a profiled function has to compile to exactly the instructions of the same
+// function without MILLI_PROFILE_SCOPE, no site, no timestamp and no registration is left behind.
+
+#include <milli/profiler.hpp>
+#include <cstddef>
+
+extern "C" long baseline_sum(const long* data, std::size_t size) {
+  long sum = 0;
+  for (std::size_t i = 0; i != size; ++i)
+    sum += data[i];
+  return sum;
+}
+
+extern "C" long profiled_sum(const long* data, std::size_t size) {
+  MILLI_PROFILE_SCOPE("profiled_sum");
+  long sum = 0;
+  for (std::size_t i = 0; i != size; ++i) {
+    MILLI_PROFILE_SCOPE("profiled_sum element");
+    sum += data[i];
+  }
+  return sum;
+}
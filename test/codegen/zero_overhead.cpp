@@ -0,0 +1,371 @@
+/*
+zero_overhead.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+// Every wrapper function below has to compile to the instructions and calls of the hand-written baseline next to it:
+// the wrappers of milli cost nothing once inlined.
+
+#include <milli/assume.hpp>
+#include <milli/attributes.hpp>
+#include <milli/cow.hpp>
+#include <milli/expected.hpp>
+#include <milli/frozen_image.hpp>
+#include <milli/intrusive_ptr.hpp>
+#include <milli/lazy.hpp>
+#include <milli/local_shared_ptr.hpp>
+#include <milli/make_container.hpp>
+#include <milli/not_empty.hpp>
+#include <milli/not_empty_d.hpp>
+#include <milli/not_empty_e.hpp>
+#include <milli/not_empty_h.hpp>
+#include <milli/not_empty_i.hpp>
+#include <milli/not_empty_range.hpp>
+#include <milli/not_empty_span.hpp>
+#include <milli/optional.hpp>
+#include <milli/raii.hpp>
+#include <milli/relocate.hpp>
+#include <milli/repeat.hpp>
+#include <milli/source_site.hpp>
+#include <milli/tagged_not_empty.hpp>
+#include <milli/tick_clock.hpp>
+#include <milli/try_make_not_empty.hpp>
+#include <milli/not_empty_t.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace {
+
+  struct int_range {
+    const int* first;
+    const int* last;
+
+    auto begin() const noexcept -> const int* {
+      return first;
+    }
+
+    auto end() const noexcept -> const int* {
+      return last;
+    }
+  };
+
+  struct node : milli::intrusive_ref_counter<node> {
+    int value;
+  };
+
+  // Container that sums what it is built from, so that only the way make_container hands over its arguments remains.
+  struct summing {
+    using value_type = int;
+
+    template<typename Iterator>
+    summing(Iterator first, Iterator last) {
+      for (; first != last; ++first)
+        sum += *first;
+    }
+
+    int sum = 0;
+  };
+
+  // The double-checked initialization lazy implements, written out.
+  struct hand_lazy {
+    std::atomic<unsigned char> state;
+    mutable int value;
+  };
+
+}
+
+// Declared noexcept, so that neither side needs a landing pad for finalizers.
+extern "C" void opaque(int value) noexcept;
+
+// not_empty_i, also with the check_once policy, and not_empty_d with NDEBUG.
+
+extern "C" int baseline_load(int* pointer) {
+  return *pointer;
+}
+
+extern "C" int not_empty_load(int* pointer) {
+  milli::not_empty_i<int*> wrapped(pointer);
+  return *wrapped;
+}
+
+extern "C" int check_once_load(int* pointer) {
+  milli::not_empty_i<int*, milli::check_once> wrapped(pointer);
+  return *wrapped;
+}
+
+extern "C" int debug_load(int* pointer) {
+  milli::not_empty_d<int*> wrapped(pointer);
+  return *wrapped;
+}
+
+// Assignment keeps what check_once tells the optimizer: the null check below folds away.
+
+extern "C" int baseline_assigned_load(int** target, int* source) {
+  *target = source;
+  return *source;
+}
+
+extern "C" int check_once_assigned_load(milli::not_empty_i<int*, milli::check_once>* target, int* source) {
+  *target = milli::not_empty_i<int*, milli::check_once>(source);
+  int* pointer = target->get();
+  return pointer ? *pointer : -1;
+}
+
+// The other flavours with check_once: a wrapper made elsewhere is read without a check, whatever the error handler.
+
+extern "C" int baseline_indirect_load(int* const* pointer) {
+  return **pointer;
+}
+
+extern "C" int hard_check_once_load(const milli::not_empty_h<int*, milli::check_once>& pointer) {
+  return *pointer;
+}
+
+extern "C" int exception_check_once_load(const milli::not_empty_e<int*, milli::check_once>& pointer) {
+  return *pointer;
+}
+
+extern "C" int telemetry_check_once_load(const milli::not_empty_t<int*, milli::check_once>& pointer) {
+  return *pointer;
+}
+
+extern "C" int baseline_sum_loads(int* const* pointers, std::size_t size) {
+  int sum = 0;
+  for (std::size_t i = 0; i != size; ++i)
+    sum += *pointers[i];
+  return sum;
+}
+
+extern "C" int not_empty_sum_loads(const milli::not_empty_i<int*, milli::check_once>* pointers, std::size_t size) {
+  int sum = 0;
+  for (std::size_t i = 0; i != size; ++i)
+    sum += *pointers[i];
+  return sum;
+}
+
+// not_empty_range: max() needs no emptiness check, the range is known to have a first element.
+
+extern "C" int baseline_max(const int* first, const int* last) {
+  const int* best = first;
+  for (const int* current = first + 1; current != last; ++current)
+    if (*best < *current)
+      best = current;
+  return *best;
+}
+
+extern "C" int not_empty_range_max(const int* first, const int* last) {
+  milli::not_empty_range<int_range> range(int_range{first, last});
+  return range.max();
+}
+
+// not_empty_span: indexed access to a span validated elsewhere is the load of the element, and at() hands it on as a
+// not_empty_i without a check.
+
+extern "C" int baseline_span_index(int* const* const* span, std::size_t index) {
+  return *(*span)[index];
+}
+
+extern "C" int not_empty_span_index(const milli::not_empty_span<int*>& span, std::size_t index) {
+  return *span[index];
+}
+
+extern "C" int not_empty_span_at(const milli::not_empty_span<int*>& span, std::size_t index) {
+  return *span.at(index);
+}
+
+// tagged_not_empty: the pointer and the tag are a mask away.
+
+extern "C" int baseline_tagged_load(std::uintptr_t word) {
+  return *reinterpret_cast<const int*>(word & ~std::uintptr_t(3));
+}
+
+extern "C" int tagged_load(std::uintptr_t word) {
+  return *milli::tagged_not_empty<const int*, 2>::from_bits(word);
+}
+
+extern "C" unsigned baseline_tag(std::uintptr_t word) {
+  return static_cast<unsigned>(word & 3);
+}
+
+extern "C" unsigned tagged_tag(std::uintptr_t word) {
+  return milli::tagged_not_empty<const int*, 2, unsigned>::from_bits(word).tag();
+}
+
+// raii and repeat.
+
+extern "C" void baseline_finalize(int value) {
+  opaque(value);
+  opaque(value + 1);
+}
+
+extern "C" void raii_finalize(int value) {
+  auto finalizer = [value]() { opaque(value + 1); };
+  milli::raii<decltype(finalizer)> guard(std::move(finalizer));
+  opaque(value);
+}
+
+extern "C" void baseline_loop(unsigned long long times) {
+  for (unsigned long long i = 0; i < times; ++i)
+    opaque(static_cast<int>(i));
+}
+
+extern "C" void repeat_loop(unsigned long long times) {
+  milli::repeat(times, [](unsigned long long i) { opaque(static_cast<int>(i)); });
+}
+
+// detail::optional, expected and try_make_not_empty on values that are there.
+
+extern "C" int baseline_value(int value) {
+  return value + 1;
+}
+
+extern "C" int optional_value(int value) {
+  milli::detail::optional<int> wrapped(std::move(value));
+  return wrapped.value() + 1;
+}
+
+extern "C" int expected_value(int value) {
+  milli::expected<int, int> wrapped(std::move(value));
+  return *wrapped + 1;
+}
+
+extern "C" int baseline_checked_load(int* pointer) {
+  int result = -1;
+  if (pointer)
+    result = *pointer;
+  return result;
+}
+
+extern "C" int try_make_not_empty_load(int* pointer) {
+  auto result = milli::try_make_not_empty(pointer);
+  return result ? **result : -1;
+}
+
+// cow, intrusive_ptr and local_shared_ptr: reading is a plain load.
+
+extern "C" int baseline_node_value(node* const& pointer) {
+  return pointer->value;
+}
+
+extern "C" int intrusive_value(const milli::intrusive_ptr<node>& pointer) {
+  return pointer->value;
+}
+
+extern "C" int baseline_shared_load(int* const& pointer) {
+  return *pointer;
+}
+
+extern "C" int cow_load(const milli::cow<int>& value) {
+  return *value;
+}
+
+extern "C" int local_shared_load(const milli::local_shared_ptr<int>& pointer) {
+  return *pointer;
+}
+
+// uninitialized_relocate: trivially relocatable wrappers of smart pointers move as one memmove.
+
+extern "C" int** baseline_relocate(int** first, int** last, int** result) {
+  auto count = static_cast<std::size_t>(last - first);
+  if (count != 0)
+    std::memmove(result, first, count * sizeof(int*));
+  return result + count;
+}
+
+extern "C" milli::not_empty_i<std::unique_ptr<int>>* relocate_not_empty(milli::not_empty_i<std::unique_ptr<int>>* first,
+                                                                        milli::not_empty_i<std::unique_ptr<int>>* last,
+                                                                        milli::not_empty_i<std::unique_ptr<int>>* result) {
+  return milli::uninitialized_relocate(first, last, result);
+}
+
+// frozen_set: a lookup in a mapped image is a binary search over the sorted keys and nothing else.
+
+extern "C" bool baseline_sorted_contains(const int* keys, std::size_t size, int key) {
+  auto position = std::lower_bound(keys, keys + size, key);
+  return position != keys + size && not (key < *position);
+}
+
+extern "C" bool frozen_set_contains(const int* keys, std::size_t size, int key) {
+  return milli::frozen_set<int>(keys, size).contains(key);
+}
+
+// lazy: once initialized, a read is one load of the state, a predicted branch and the load of the value.
+
+extern "C" int& hand_lazy_initialize(const hand_lazy& lazy);
+
+static int& baseline_lazy_get(const hand_lazy& lazy) {
+  if (MILLI_LIKELY(lazy.state.load(std::memory_order_acquire) == 2))
+    return lazy.value;
+  return hand_lazy_initialize(lazy);
+}
+
+extern "C" int baseline_lazy_read(const hand_lazy& lazy) {
+  return baseline_lazy_get(lazy);
+}
+
+extern "C" int lazy_read(const milli::lazy<int>& lazy) {
+  return *lazy;
+}
+
+// make_container: trivially copyable arguments, copied or moved, cost what the initializer list of Container{...} does.
+
+extern "C" int baseline_sum(int first, int second, int third) {
+  std::initializer_list<int> list{first, second, third};
+  return summing(list.begin(), list.end()).sum;
+}
+
+extern "C" int make_container_copied_sum(int first, int second, int third) {
+  return milli::make_container<summing>(first, second, third).sum;
+}
+
+extern "C" int make_container_moved_sum(int first, int second, int third) {
+  return milli::make_container<summing>(std::move(first), std::move(second), std::move(third)).sum;
+}
+
+// source_site::current() is a constant, and reading the tick clock is the one instruction reading the counter.
+
+extern "C" unsigned baseline_line() {
+  return 1;
+}
+
+extern "C" unsigned site_line() {
+  return milli::source_site::current().line;
+}
+
+extern "C" std::uint64_t baseline_ticks() {
+#ifdef MILLI_DETAIL_TICKS_ARE_CYCLES
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+extern "C" std::uint64_t tick_read() {
+  return milli::detail::read_ticks();
+}
+
+// MILLI_ASSUME lets the optimizer drop a check.
+
+extern "C" int assumed_load(int* pointer) {
+  MILLI_ASSUME(pointer != nullptr);
+  return pointer ? *pointer : -1;
+}
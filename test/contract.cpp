@@ -0,0 +1,127 @@
+/*
+contract.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#define MILLI_CONTRACT_LEVEL MILLI_CONTRACT_DEFAULT
+#include <milli/contract.hpp>
+#include <milli/not_empty_d.hpp>
+
+#define BOOST_TEST_MODULE contract test
+#include <boost/test/included/unit_test.hpp>
+
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#define MILLI_TEST_FORK
+#endif
+
+namespace {
+  int evaluations = 0;
+
+  auto counted(bool value) -> bool {
+    ++evaluations;
+    return value;
+  }
+
+  auto checked_divide(int dividend, int divisor) -> int {
+    MILLI_EXPECTS(divisor != 0);
+    int result = dividend / divisor;
+    MILLI_ENSURES(result * divisor <= dividend);
+    return result;
+  }
+
+#ifdef MILLI_TEST_FORK
+  // Runs function in a child process and returns what it wrote to stderr; the child has to be killed by SIGABRT.
+  template<typename Function>
+  auto stderr_of_aborted_child(Function function) -> std::string {
+    int pipe_ends[2];
+    BOOST_REQUIRE(pipe(pipe_ends) == 0);
+
+    pid_t child = fork();
+    BOOST_REQUIRE(child >= 0);
+    if(child == 0){
+      std::signal(SIGABRT, SIG_DFL);
+      dup2(pipe_ends[1], 2);
+      close(pipe_ends[0]);
+      function();
+      _exit(0);
+    }
+
+    close(pipe_ends[1]);
+    std::string output;
+    char buffer[256];
+    ssize_t size;
+    while((size = read(pipe_ends[0], buffer, sizeof(buffer))) > 0)
+      output.append(buffer, static_cast<std::size_t>(size));
+    close(pipe_ends[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    BOOST_TEST(WIFSIGNALED(status));
+    return output;
+  }
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE(contract_test_suite)
+
+  BOOST_AUTO_TEST_CASE(passing_checks) {
+    BOOST_TEST(checked_divide(7, 2) == 3);
+    MILLI_ASSERT_HOT(true);
+    MILLI_ASSERT(1 + 1 == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(enabled_levels_are_evaluated_once) {
+    evaluations = 0;
+    MILLI_EXPECTS_HOT(counted(true));
+    MILLI_EXPECTS(counted(true));
+    BOOST_TEST(evaluations == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(audit_level_is_not_evaluated) {
+    evaluations = 0;
+    MILLI_ASSERT_AUDIT(counted(false));
+    MILLI_ENSURES_AUDIT(counted(false));
+    BOOST_TEST(evaluations == 0);
+  }
+
+#ifdef MILLI_TEST_FORK
+
+  BOOST_AUTO_TEST_CASE(violated_precondition_names_condition_and_location) {
+    auto output = stderr_of_aborted_child([]{ checked_divide(1, 0); });
+
+    BOOST_TEST(output.find("contract.cpp:") != std::string::npos);
+    BOOST_TEST(output.find(" :=> precondition failed: divisor != 0\n") != std::string::npos);
+  }
+
+  BOOST_AUTO_TEST_CASE(violated_hot_assertion) {
+    auto output = stderr_of_aborted_child([]{ MILLI_ASSERT_HOT(evaluations < 0); });
+    BOOST_TEST(output.find("assertion failed: evaluations < 0") != std::string::npos);
+  }
+
+  BOOST_AUTO_TEST_CASE(not_empty_d_uses_milli_assert) {
+    auto output = stderr_of_aborted_child([]{
+      int* empty = nullptr;
+      milli::not_empty_d<int*> test(empty);
+    });
+    BOOST_TEST(output.find("assertion failed: condition") != std::string::npos);
+  }
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
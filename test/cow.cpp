@@ -0,0 +1,151 @@
+/*
+cow.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/cow.hpp>
+#include "instrumentation.hpp"
+
+#define BOOST_TEST_MODULE cow test
+#include <boost/test/included/unit_test.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace milli;
+
+namespace {
+  struct copy_counter {
+    explicit copy_counter(int& copies) : copies(&copies) {}
+    copy_counter(const copy_counter& rhs) : copies(rhs.copies), value(rhs.value) { ++*copies; }
+    int* copies;
+    int value = 0;
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(cow_test_suite)
+
+  BOOST_AUTO_TEST_CASE(default_holds_value) {
+    cow<std::string> test;
+
+    BOOST_TEST(test->empty());
+    BOOST_TEST(test.use_count() == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(copies_share) {
+    cow<std::vector<int>> test(std::vector<int>{1, 2, 3});
+    auto copy = test;
+
+    BOOST_TEST(test.use_count() == 2);
+    BOOST_TEST(&*copy == &*test);
+    BOOST_TEST(copy.get().size() == 3u);
+  }
+
+  BOOST_AUTO_TEST_CASE(move_transfers_the_value) {
+    cow<std::string> test(std::string("value"));
+    auto moved = std::move(test);
+
+    BOOST_TEST(*moved == "value");
+    BOOST_TEST(moved.use_count() == 1);
+
+    cow<std::string> assigned;
+    assigned = std::move(moved);
+    BOOST_TEST(*assigned == "value");
+    BOOST_TEST(assigned.use_count() == 1);
+
+    test = assigned;
+    BOOST_TEST(*test == "value");
+    BOOST_TEST(assigned.use_count() == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(write_after_move_does_not_clone) {
+    cow<test::counted<int>> value(test::counted<int>(1));
+    cow<test::counted<int>> assigned;
+
+    MILLI_EXPECT_COPIES(0) {
+      auto moved = std::move(value);
+      moved.write() = test::counted<int>(2);
+      assigned = std::move(moved);
+      assigned.write() = test::counted<int>(3);
+    }
+    BOOST_TEST(assigned->value() == 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(write_clones_shared_value) {
+    int copies = 0;
+    auto test = make_cow<copy_counter>(copies);
+    auto copy = test;
+
+    copy.write().value = 5;
+
+    BOOST_TEST(copies == 1);
+    BOOST_TEST(test->value == 0);
+    BOOST_TEST(copy->value == 5);
+    BOOST_TEST(test.use_count() == 1);
+    BOOST_TEST(copy.use_count() == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(write_to_unique_value_does_not_clone) {
+    int copies = 0;
+    auto test = make_cow<copy_counter>(copies);
+    const copy_counter* original = &*test;
+
+    test.write().value = 1;
+    test.write().value = 2;
+
+    BOOST_TEST(copies == 0);
+    BOOST_TEST(&*test == original);
+    BOOST_TEST(test->value == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(clone_after_copy_is_gone) {
+    int copies = 0;
+    auto test = make_cow<copy_counter>(copies);
+    {
+      auto copy = test;
+      BOOST_TEST(test.use_count() == 2);
+    }
+    test.write().value = 3;
+
+    BOOST_TEST(copies == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(share_keeps_readers_stable) {
+    cow<std::string> test(std::string("milli"));
+    auto shared = test.share();
+
+    test.write() += " library";
+
+    BOOST_TEST(*shared == "milli");
+    BOOST_TEST(*test == "milli library");
+  }
+
+  BOOST_AUTO_TEST_CASE(copies_written_on_other_threads) {
+    cow<std::vector<int>> test(std::vector<int>(100, 1));
+    std::vector<std::thread> writers;
+    for(int index = 0; index != 4; ++index){
+      writers.emplace_back([test, index]() mutable {
+        for(auto& value : test.write())
+          value = index;
+      });
+    }
+    for(auto& writer : writers)
+      writer.join();
+
+    BOOST_TEST(test->front() == 1);
+    BOOST_TEST(test.use_count() == 1);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,124 @@
+/*
+expected.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#define BOOST_TEST_MODULE expected test
+
+#include <boost/test/included/unit_test.hpp>
+#include <milli/expected.hpp>
+#include <milli/try_make_not_empty.hpp>
+#include <memory>
+
+using namespace milli;
+
+BOOST_AUTO_TEST_SUITE(expected_test_suite)
+
+  BOOST_AUTO_TEST_CASE(value_alternative) {
+    expected<int, int> test(5);
+
+    BOOST_TEST(test.has_value());
+    BOOST_TEST(static_cast<bool>(test));
+    BOOST_TEST(*test == 5);
+  }
+
+  BOOST_AUTO_TEST_CASE(error_alternative) {
+    expected<int, int> test(make_unexpected(3));
+
+    BOOST_TEST(not test.has_value());
+    BOOST_TEST(test.error() == 3);
+    BOOST_TEST(std::move(test).value_or(7) == 7);
+  }
+
+  BOOST_AUTO_TEST_CASE(value_is_destroyed) {
+    auto shared = std::make_shared<int>(1);
+    {
+      expected<std::shared_ptr<int>, int> test(std::shared_ptr<int>{shared});
+      BOOST_TEST(shared.use_count() == 2);
+    }
+    BOOST_TEST(shared.use_count() == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(and_then_chaining) {
+    auto half = [](int value) -> expected<int, int> {
+      if(value % 2)
+        return make_unexpected(value);
+      return value / 2;
+    };
+
+    BOOST_TEST((*expected<int, int>(8).and_then(half).and_then(half) == 2));
+    BOOST_TEST((expected<int, int>(6).and_then(half).and_then(half).error() == 3));
+  }
+
+  BOOST_AUTO_TEST_CASE(or_else_recovery) {
+    auto recover = [](int error) -> expected<int, int> { return error * 10; };
+    auto fail = [](int error) -> expected<int, int> { return make_unexpected(error + 1); };
+
+    BOOST_TEST((*expected<int, int>(make_unexpected(4)).or_else(recover) == 40));
+    BOOST_TEST((*expected<int, int>(1).or_else(fail) == 1));
+    BOOST_TEST((expected<int, int>(make_unexpected(4)).or_else(fail).error() == 5));
+  }
+
+  BOOST_AUTO_TEST_CASE(move_only_value) {
+    expected<std::unique_ptr<int>, int> test(std::unique_ptr<int>(new int(3)));
+    auto moved = std::move(test);
+
+    BOOST_TEST(**moved == 3);
+    BOOST_TEST(not test.has_value());
+  }
+
+  BOOST_AUTO_TEST_CASE(try_make_not_empty_success) {
+    int value = 1;
+    auto result = try_make_not_empty(&value);
+
+    constexpr bool proper_type = std::is_same<decltype(result), expected<not_empty_i<int*>, not_empty_error>>::value;
+    BOOST_TEST(proper_type);
+    BOOST_TEST(result.has_value());
+    BOOST_TEST(**result == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(try_make_not_empty_failure) {
+    int* null = nullptr;
+    auto result = try_make_not_empty(null);
+
+    BOOST_TEST(not result.has_value());
+    BOOST_TEST((result.error() == not_empty_error::empty_value));
+
+    constexpr bool is_noexcept = noexcept(try_make_not_empty(null));
+    BOOST_TEST(is_noexcept);
+  }
+
+  BOOST_AUTO_TEST_CASE(try_make_not_empty_explicit_type) {
+    auto result = try_make_not_empty<std::shared_ptr<int>>(std::make_shared<int>(4));
+    BOOST_TEST(**result == 4);
+
+    auto empty = try_make_not_empty<std::shared_ptr<int>>(std::shared_ptr<int>());
+    BOOST_TEST(not empty.has_value());
+  }
+
+  BOOST_AUTO_TEST_CASE(try_make_not_empty_chaining) {
+    int value = 2;
+    auto doubled = try_make_not_empty(&value).and_then([](not_empty_i<int*> pointer) -> expected<int, not_empty_error> {
+      return *pointer * 2;
+    });
+    BOOST_TEST(*doubled == 4);
+
+    int* null = nullptr;
+    auto fallback = try_make_not_empty(null).or_else([&value](not_empty_error) -> not_empty_result<int*> {
+      return not_empty_i<int*>(&value);
+    });
+    BOOST_TEST(*fallback->get() == 2);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
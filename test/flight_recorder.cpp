@@ -0,0 +1,209 @@
+/*
+flight_recorder.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/flight_recorder.hpp>
+#include <milli/not_empty_h.hpp>
+
+#define BOOST_TEST_MODULE flight_recorder test
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#define MILLI_TEST_FORK
+#endif
+
+using namespace milli;
+
+namespace {
+  enum class color { red = 7 };
+
+  // Collects what function writes to the file descriptor it is given.
+  template<typename Function>
+  auto capture(Function function) -> std::string {
+    std::FILE* file = std::tmpfile();
+    BOOST_REQUIRE(file);
+    function(fileno(file));
+
+    std::string result;
+    std::rewind(file);
+    char buffer[256];
+    std::size_t size;
+    while((size = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+      result.append(buffer, size);
+    std::fclose(file);
+    return result;
+  }
+
+  auto count(const std::string& text, const std::string& part) -> std::size_t {
+    std::size_t result = 0;
+    for(auto position = text.find(part); position != std::string::npos; position = text.find(part, position + 1))
+      ++result;
+    return result;
+  }
+
+#ifdef MILLI_TEST_FORK
+  // Runs function in a child process and collects what it wrote to stderr.
+  template<typename Function>
+  auto run_in_child(Function function) -> std::string {
+    int pipe_ends[2];
+    BOOST_REQUIRE(pipe(pipe_ends) == 0);
+
+    pid_t child = fork();
+    BOOST_REQUIRE(child >= 0);
+    if(child == 0){
+      std::signal(SIGABRT, SIG_DFL);
+      dup2(pipe_ends[1], 2);
+      close(pipe_ends[0]);
+      function();
+      _exit(0);
+    }
+
+    close(pipe_ends[1]);
+    std::string result;
+    char buffer[256];
+    ssize_t size;
+    while((size = read(pipe_ends[0], buffer, sizeof(buffer))) > 0)
+      result.append(buffer, static_cast<std::size_t>(size));
+    close(pipe_ends[0]);
+    int status;
+    waitpid(child, &status, 0);
+    return result;
+  }
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE(flight_recorder_test_suite)
+
+  BOOST_AUTO_TEST_CASE(dump_shows_name_and_arguments) {
+    int value = -3;
+    MILLI_TRACE("request_started", 1, value, color::red);
+    MILLI_TRACE("request_finished");
+
+    auto text = capture([](int descriptor){ flight_recorder::dump(descriptor); });
+    BOOST_TEST(text.find("milli flight recorder") == 0u);
+    BOOST_TEST(text.find(" request_started 1 -3 7\n") != std::string::npos);
+    BOOST_TEST(text.find(" request_finished\n") != std::string::npos);
+    BOOST_TEST(text.find(" request_started") < text.find(" request_finished"));
+  }
+
+  BOOST_AUTO_TEST_CASE(long_names_are_truncated) {
+    MILLI_TRACE("a_name_longer_than_twenty_three_characters", 1u);
+
+    auto text = capture([](int descriptor){ flight_recorder::dump(descriptor); });
+    BOOST_TEST(text.find(" a_name_longer_than_twen 1\n") != std::string::npos);
+  }
+
+  BOOST_AUTO_TEST_CASE(rings_keep_the_latest_events_of_every_thread) {
+    const std::size_t capacity = flight_recorder::events_per_thread;
+    std::thread([capacity]{
+      for(std::size_t index = 0; index != 2 * capacity; ++index)
+        MILLI_TRACE("wrapped", index);
+    }).join();
+
+    auto text = capture([](int descriptor){ flight_recorder::dump(descriptor); });
+    BOOST_TEST(count(text, " wrapped ") == capacity);
+    BOOST_TEST(text.find(" wrapped " + std::to_string(capacity) + "\n") != std::string::npos);
+    BOOST_TEST(text.find(" wrapped " + std::to_string(2 * capacity - 1) + "\n") != std::string::npos);
+    BOOST_TEST(text.find(" wrapped 0\n") == std::string::npos);
+  }
+
+  BOOST_AUTO_TEST_CASE(decode_rejects_other_data) {
+    const char data[128] = "not a dump";
+    auto text = capture([&data](int descriptor){ BOOST_TEST(not flight_recorder::decode(data, sizeof(data), descriptor)); });
+    BOOST_TEST(text.empty());
+  }
+
+#ifdef MILLI_TEST_FORK
+
+  BOOST_AUTO_TEST_CASE(binary_dump_decodes_to_the_events) {
+    MILLI_TRACE("mapped_event", 11, -12);
+
+    char path[] = "/tmp/milli_flight_recorderXXXXXX";
+    int descriptor = mkstemp(path);
+    BOOST_REQUIRE(descriptor >= 0);
+    close(descriptor);
+
+    // Mapping is once per process, so it happens in a child.
+    auto text = run_in_child([&path]{
+      if(flight_recorder::map_file(path) && flight_recorder::dump_to_file())
+        _exit(0);
+      _exit(1);
+    });
+    BOOST_TEST(text.empty());
+
+    std::string dump;
+    std::FILE* file = std::fopen(path, "rb");
+    BOOST_REQUIRE(file);
+    char buffer[4096];
+    std::size_t size;
+    while((size = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+      dump.append(buffer, size);
+    std::fclose(file);
+    std::remove(path);
+
+    auto decoded = capture([&dump](int output){ BOOST_TEST(flight_recorder::decode(dump.data(), dump.size(), output)); });
+    BOOST_TEST(decoded.find(" mapped_event 11 -12\n") != std::string::npos);
+    BOOST_TEST(not flight_recorder::decode(dump.data(), 16, 1));
+  }
+
+  BOOST_AUTO_TEST_CASE(strong_assert_dumps_before_terminating) {
+    auto text = run_in_child([]{
+      MILLI_TRACE("before_failure", 42);
+      strong_assert(false, "failed");
+    });
+
+    BOOST_TEST(text.find("failed\n") == 0u);
+    BOOST_TEST(text.find(" before_failure 42\n") != std::string::npos);
+  }
+
+  BOOST_AUTO_TEST_CASE(hard_error_handler_dumps_before_terminating) {
+    auto text = run_in_child([]{
+      MILLI_TRACE("before_empty_value", 1);
+      int* empty = nullptr;
+      not_empty_h<int*> value(empty);
+      static_cast<void>(value);
+    });
+
+    BOOST_TEST(text.find("Value in not_empty was empty") != std::string::npos);
+    BOOST_TEST(text.find(" before_empty_value 1\n") != std::string::npos);
+  }
+
+  BOOST_AUTO_TEST_CASE(failure_in_the_mapped_file_is_reported_on_stderr) {
+    char path[] = "/tmp/milli_flight_recorderXXXXXX";
+    int descriptor = mkstemp(path);
+    BOOST_REQUIRE(descriptor >= 0);
+    close(descriptor);
+
+    auto text = run_in_child([&path]{
+      if(not flight_recorder::map_file(path))
+        _exit(1);
+      MILLI_TRACE("into_file", 5);
+      strong_assert(false, "failed");
+    });
+    BOOST_TEST(text.find(std::string("milli flight recorder dumped to ") + path + "\n") != std::string::npos);
+    BOOST_TEST(text.find("into_file") == std::string::npos);
+    std::remove(path);
+  }
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,249 @@
+/*
+frozen_image.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <milli/frozen_image.hpp>
+#include <milli/make_container.hpp>
+
+#define BOOST_TEST_MODULE frozen_image test
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace milli;
+
+namespace {
+
+  struct quote {
+    std::uint32_t bid;
+    std::uint32_t ask;
+  };
+
+  // File in the working directory, removed at the end of the test. The name includes the standard, the test is run
+  // once per standard, possibly in parallel.
+  struct scratch_file {
+    explicit scratch_file(const std::string& name)
+        : path("frozen_image_" + std::to_string(__cplusplus) + "_" + name + ".img") {}
+
+    ~scratch_file() {
+      std::remove(path.c_str());
+    }
+
+    auto read() const -> std::vector<char> {
+      std::ifstream file(path, std::ios::binary);
+      return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    auto overwrite(const std::vector<char>& bytes) const -> void {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::string path;
+  };
+
+  template<typename Range>
+  auto elements(const Range& range) -> std::vector<typename Range::value_type> {
+    return std::vector<typename Range::value_type>(range.begin(), range.end());
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(frozen_image_test_suite)
+
+  BOOST_AUTO_TEST_CASE(vector_keeps_the_order_of_elements){
+    scratch_file file("vector");
+    frozen_image<frozen_vector<int>>::write(file.path, make_container<std::vector<int>>(3, 1, 2));
+
+    auto image = frozen_image<frozen_vector<int>>::open(file.path);
+    BOOST_TEST(elements(*image) == (std::vector<int>{3, 1, 2}));
+    BOOST_TEST((*image)[2] == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(image_holds_offsets_not_pointers){
+    scratch_file file("offsets");
+    frozen_image<frozen_vector<quote>>::write(file.path, std::vector<quote>{{1, 2}, {3, 4}});
+
+    auto first = frozen_image<frozen_vector<quote>>::open(file.path);
+    auto second = frozen_image<frozen_vector<quote>>::open(file.path);
+    BOOST_TEST(first->data() != second->data());
+    BOOST_TEST(second->data()[1].bid == 3u);
+    BOOST_TEST(second->data()[1].ask == 4u);
+    BOOST_TEST(reinterpret_cast<std::uintptr_t>(first->data()) % alignof(quote) == 0u);
+  }
+
+  BOOST_AUTO_TEST_CASE(empty_containers_round_trip){
+    scratch_file file("empty");
+    frozen_image<frozen_set<int>>::write(file.path, std::vector<int>{});
+
+    auto image = frozen_image<frozen_set<int>>::open(file.path);
+    BOOST_TEST(image->empty());
+    BOOST_TEST(not image->contains(1));
+  }
+
+  BOOST_AUTO_TEST_CASE(set_is_sorted_and_unique){
+    scratch_file file("set");
+    frozen_image<frozen_set<int>>::write(file.path, std::vector<int>{5, 1, 3, 1, 5});
+
+    auto image = frozen_image<frozen_set<int>>::open(file.path);
+    BOOST_TEST(elements(*image) == (std::vector<int>{1, 3, 5}));
+    BOOST_TEST(image->contains(3));
+    BOOST_TEST(not image->contains(4));
+    BOOST_TEST(image->count(5) == 1u);
+    BOOST_TEST(image->find(2) == image->end());
+    BOOST_TEST(*image->lower_bound(2) == 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(set_uses_its_comparison){
+    scratch_file file("descending");
+    frozen_image<frozen_set<int, std::greater<int>>>::write(file.path, std::vector<int>{1, 3, 2});
+
+    auto image = frozen_image<frozen_set<int, std::greater<int>>>::open(file.path);
+    BOOST_TEST(elements(*image) == (std::vector<int>{3, 2, 1}));
+    BOOST_TEST(image->contains(1));
+  }
+
+  BOOST_AUTO_TEST_CASE(map_is_written_from_a_std_map){
+    scratch_file file("map");
+    std::map<std::uint64_t, quote> quotes{{7, {70, 71}}, {3, {30, 31}}, {5, {50, 51}}};
+    frozen_image<frozen_map<std::uint64_t, quote>>::write(file.path, quotes);
+
+    auto image = frozen_image<frozen_map<std::uint64_t, quote>>::open(file.path);
+    BOOST_TEST(image->size() == 3u);
+    BOOST_TEST(elements(image->keys()) == (std::vector<std::uint64_t>{3, 5, 7}));
+    BOOST_TEST(image->find(5)->ask == 51u);
+    BOOST_TEST(image->find(4) == nullptr);
+    BOOST_TEST(image->at(7).bid == 70u);
+    BOOST_CHECK_THROW(image->at(8), std::out_of_range);
+    BOOST_TEST(image->contains(3));
+    BOOST_TEST(image->count(6) == 0u);
+  }
+
+  BOOST_AUTO_TEST_CASE(map_keeps_the_first_of_equal_keys){
+    scratch_file file("duplicates");
+    std::vector<std::pair<int, int>> entries{{2, 20}, {1, 10}, {2, 21}};
+    frozen_image<frozen_map<int, int>>::write(file.path, entries);
+
+    auto image = frozen_image<frozen_map<int, int>>::open(file.path);
+    BOOST_TEST(elements(image->keys()) == (std::vector<int>{1, 2}));
+    BOOST_TEST(elements(image->values()) == (std::vector<int>{10, 20}));
+  }
+
+  BOOST_AUTO_TEST_CASE(moved_from_image_is_empty){
+    scratch_file file("moved");
+    frozen_image<frozen_vector<int>>::write(file.path, std::vector<int>{1, 2});
+
+    auto image = frozen_image<frozen_vector<int>>::open(file.path);
+    auto moved = std::move(image);
+    BOOST_TEST(image->empty());
+    BOOST_TEST(image.image_size() == 0u);
+    BOOST_TEST(elements(*moved) == (std::vector<int>{1, 2}));
+
+    image = std::move(moved);
+    BOOST_TEST(elements(*image) == (std::vector<int>{1, 2}));
+  }
+
+  BOOST_AUTO_TEST_CASE(rewriting_leaves_open_images_intact){
+    scratch_file file("rewrite");
+    frozen_image<frozen_vector<int>>::write(file.path, std::vector<int>{1, 2, 3});
+    auto old_image = frozen_image<frozen_vector<int>>::open(file.path);
+
+    frozen_image<frozen_vector<int>>::write(file.path, std::vector<int>{4});
+    auto new_image = frozen_image<frozen_vector<int>>::open(file.path);
+    BOOST_TEST(elements(*old_image) == (std::vector<int>{1, 2, 3}));
+    BOOST_TEST(elements(*new_image) == (std::vector<int>{4}));
+  }
+
+  BOOST_AUTO_TEST_CASE(concurrent_writers_do_not_mix_their_images){
+    scratch_file file("concurrent");
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer != 4; ++writer) {
+      writers.emplace_back([&file, writer]() {
+        for (int round = 0; round != 20; ++round)
+          frozen_image<frozen_vector<int>>::write(file.path, std::vector<int>(1000 + writer, writer));
+      });
+    }
+    for (auto& writer : writers)
+      writer.join();
+
+    auto image = frozen_image<frozen_vector<int>>::open(file.path);
+    int writer = (*image)[0];
+    BOOST_TEST(elements(*image) == std::vector<int>(1000 + writer, writer));
+  }
+
+  BOOST_AUTO_TEST_CASE(missing_file_is_a_system_error){
+    BOOST_CHECK_THROW(frozen_image<frozen_vector<int>>::open("frozen_image_does_not_exist.img"), std::system_error);
+    BOOST_CHECK_THROW(frozen_image<frozen_vector<int>>::write("no/such/directory.img", std::vector<int>{1}),
+                      std::system_error);
+  }
+
+  BOOST_AUTO_TEST_CASE(images_of_other_types_are_refused){
+    scratch_file file("types");
+    frozen_image<frozen_set<int>>::write(file.path, std::vector<int>{1, 2});
+    using int_map = frozen_map<int, int>;
+
+    BOOST_CHECK_THROW(frozen_image<frozen_vector<int>>::open(file.path), frozen_image_error);
+    BOOST_CHECK_THROW(frozen_image<frozen_set<std::uint64_t>>::open(file.path), frozen_image_error);
+    BOOST_CHECK_THROW(frozen_image<int_map>::open(file.path), frozen_image_error);
+  }
+
+  BOOST_AUTO_TEST_CASE(layout_version_has_to_match){
+    scratch_file file("version");
+    frozen_image<frozen_vector<int>>::write(file.path, std::vector<int>{1}, 2);
+
+    BOOST_CHECK_THROW(frozen_image<frozen_vector<int>>::open(file.path), frozen_image_error);
+    BOOST_TEST(frozen_image<frozen_vector<int>>::open(file.path, frozen_check::checksum, 2)->size() == 1u);
+  }
+
+  BOOST_AUTO_TEST_CASE(corrupt_elements_fail_the_checksum){
+    scratch_file file("corrupt");
+    frozen_image<frozen_vector<int>>::write(file.path, std::vector<int>{1, 2, 3});
+    auto bytes = file.read();
+    bytes[bytes.size() - 1] ^= 1;
+    file.overwrite(bytes);
+
+    BOOST_CHECK_THROW(frozen_image<frozen_vector<int>>::open(file.path), frozen_image_error);
+    BOOST_TEST(frozen_image<frozen_vector<int>>::open(file.path, frozen_check::header)->size() == 3u);
+  }
+
+  BOOST_AUTO_TEST_CASE(truncated_and_foreign_files_are_refused){
+    scratch_file file("truncated");
+    frozen_image<frozen_vector<int>>::write(file.path, std::vector<int>{1, 2, 3});
+    auto bytes = file.read();
+
+    file.overwrite(std::vector<char>(bytes.begin(), bytes.end() - 1));
+    BOOST_CHECK_THROW(frozen_image<frozen_vector<int>>::open(file.path, frozen_check::header), frozen_image_error);
+
+    file.overwrite(std::vector<char>(bytes.begin(), bytes.begin() + 16));
+    BOOST_CHECK_THROW(frozen_image<frozen_vector<int>>::open(file.path), frozen_image_error);
+
+    bytes[0] = 'X';
+    file.overwrite(bytes);
+    BOOST_CHECK_THROW(frozen_image<frozen_vector<int>>::open(file.path), frozen_image_error);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,349 @@
+/*
+instrumentation.hpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MILLI_TEST_INSTRUMENTATION_HPP
+#define MILLI_TEST_INSTRUMENTATION_HPP
+
+// Instrumentation for tests of performance properties: how often a piece of code allocates and how often it copies,
+// moves and destroys values. Budgets are checked with Boost.Test, reported at the line of the check:
+//
+//   MILLI_EXPECT_ALLOCS(1) MILLI_EXPECT_COPIES(0) {
+//     auto values = make_container<std::vector<counted<int>>>(counted<int>(1), counted<int>(2));
+//   }
+//
+// The header replaces the global operator new and delete, so a test program may include it from one translation unit
+// only, after Boost.Test. Counters are per thread; allocations and operations of other threads are not seen. Checks
+// that pass do not allocate, but a failing one nested in MILLI_EXPECT_ALLOCS adds the allocations of its report.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace milli {
+  namespace test {
+
+    struct allocation_counts {
+      std::uint64_t allocations;
+      std::uint64_t deallocations;
+      std::uint64_t bytes;
+    };
+
+    struct operation_counts {
+      std::uint64_t constructions;
+      std::uint64_t copies;
+      std::uint64_t moves;
+      std::uint64_t destructions;
+    };
+
+    namespace detail {
+
+      // Trivial types, so the counters are initialized before anything can allocate and need no destruction.
+      inline auto thread_allocations() noexcept -> allocation_counts& {
+        static thread_local allocation_counts counts{0, 0, 0};
+        return counts;
+      }
+
+      inline auto thread_operations() noexcept -> operation_counts& {
+        static thread_local operation_counts counts{0, 0, 0, 0};
+        return counts;
+      }
+
+      inline auto allocate(std::size_t size) noexcept -> void* {
+        auto& counts = thread_allocations();
+        ++counts.allocations;
+        counts.bytes += size;
+        return std::malloc(size == 0 ? 1 : size);
+      }
+
+      inline auto deallocate(void* pointer) noexcept -> void {
+        if (not pointer)
+          return;
+        ++thread_allocations().deallocations;
+        std::free(pointer);
+      }
+
+#ifdef __cpp_aligned_new
+      inline auto allocate(std::size_t size, std::align_val_t alignment) noexcept -> void* {
+        auto& counts = thread_allocations();
+        ++counts.allocations;
+        counts.bytes += size;
+        auto align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+        return std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align);
+#endif
+      }
+
+      inline auto deallocate(void* pointer, std::align_val_t) noexcept -> void {
+        if (not pointer)
+          return;
+        ++thread_allocations().deallocations;
+#ifdef _MSC_VER
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+      }
+#endif
+    }
+
+    // Counts of the calling thread since construction, or up to stop().
+    class measurement {
+    public:
+      measurement() noexcept
+          : allocations_start_(detail::thread_allocations()), operations_start_(detail::thread_operations()),
+            allocations_end_(), operations_end_(), stopped_(false) {}
+
+      auto stop() noexcept -> void {
+        allocations_end_ = detail::thread_allocations();
+        operations_end_ = detail::thread_operations();
+        stopped_ = true;
+      }
+
+      auto allocations() const noexcept -> std::uint64_t {
+        return allocations_end().allocations - allocations_start_.allocations;
+      }
+
+      auto deallocations() const noexcept -> std::uint64_t {
+        return allocations_end().deallocations - allocations_start_.deallocations;
+      }
+
+      auto bytes() const noexcept -> std::uint64_t {
+        return allocations_end().bytes - allocations_start_.bytes;
+      }
+
+      auto constructions() const noexcept -> std::uint64_t {
+        return operations_end().constructions - operations_start_.constructions;
+      }
+
+      auto copies() const noexcept -> std::uint64_t {
+        return operations_end().copies - operations_start_.copies;
+      }
+
+      auto moves() const noexcept -> std::uint64_t {
+        return operations_end().moves - operations_start_.moves;
+      }
+
+      auto destructions() const noexcept -> std::uint64_t {
+        return operations_end().destructions - operations_start_.destructions;
+      }
+
+    private:
+      auto allocations_end() const noexcept -> const allocation_counts& {
+        return stopped_ ? allocations_end_ : detail::thread_allocations();
+      }
+
+      auto operations_end() const noexcept -> const operation_counts& {
+        return stopped_ ? operations_end_ : detail::thread_operations();
+      }
+
+      allocation_counts allocations_start_;
+      operation_counts operations_start_;
+      allocation_counts allocations_end_;
+      operation_counts operations_end_;
+      bool stopped_;
+    };
+
+    namespace detail {
+
+      // Drives the for loop of the MILLI_EXPECT_ macros: the first pass runs the block, the second stops the
+      // measurement, so that nothing Boost.Test does is counted, and checks it.
+      class expectation : public measurement {
+      public:
+        auto next() noexcept -> bool {
+          if (pass_ == 1)
+            stop();
+          return pass_++ < 2;
+        }
+
+        auto checking() const noexcept -> bool {
+          return pass_ == 2;
+        }
+
+      private:
+        int pass_ = 0;
+      };
+    }
+
+    // Value of type T that counts its constructions, copies, moves and destructions. Copy and move assignments count
+    // as copies and moves.
+    template<typename T>
+    class counted {
+    public:
+      counted() : value_() {
+        ++detail::thread_operations().constructions;
+      }
+
+      counted(T value) : value_(std::move(value)) {
+        ++detail::thread_operations().constructions;
+      }
+
+      counted(const counted& other) : value_(other.value_) {
+        ++detail::thread_operations().copies;
+      }
+
+      counted(counted&& other) noexcept : value_(std::move(other.value_)) {
+        ++detail::thread_operations().moves;
+      }
+
+      auto operator=(const counted& other) -> counted& {
+        value_ = other.value_;
+        ++detail::thread_operations().copies;
+        return *this;
+      }
+
+      auto operator=(counted&& other) noexcept -> counted& {
+        value_ = std::move(other.value_);
+        ++detail::thread_operations().moves;
+        return *this;
+      }
+
+      ~counted() {
+        ++detail::thread_operations().destructions;
+      }
+
+      auto value() noexcept -> T& {
+        return value_;
+      }
+
+      auto value() const noexcept -> const T& {
+        return value_;
+      }
+
+      friend auto operator==(const counted& lhs, const counted& rhs) -> bool {
+        return lhs.value_ == rhs.value_;
+      }
+
+      friend auto operator!=(const counted& lhs, const counted& rhs) -> bool {
+        return not (lhs == rhs);
+      }
+
+    private:
+      T value_;
+    };
+
+  }
+}
+
+#define MILLI_DETAIL_TEST_CONCATENATE_EXPANDED(lhs, rhs) lhs##rhs
+#define MILLI_DETAIL_TEST_CONCATENATE(lhs, rhs) MILLI_DETAIL_TEST_CONCATENATE_EXPANDED(lhs, rhs)
+
+#define MILLI_DETAIL_EXPECT(name, counter, expected)                      \
+  for (::milli::test::detail::expectation name; name.next();)             \
+    if (name.checking()) {                                                \
+      BOOST_TEST(name.counter() == static_cast<std::uint64_t>(expected)); \
+    } else
+
+#define MILLI_DETAIL_EXPECT_UNIQUE(counter, expected) \
+  MILLI_DETAIL_EXPECT(MILLI_DETAIL_TEST_CONCATENATE(milli_expectation_, __COUNTER__), counter, expected)
+
+// Each is followed by a statement or block and checks how often it allocated, copied or moved counted values.
+#define MILLI_EXPECT_ALLOCS(expected) MILLI_DETAIL_EXPECT_UNIQUE(allocations, expected)
+#define MILLI_EXPECT_COPIES(expected) MILLI_DETAIL_EXPECT_UNIQUE(copies, expected)
+#define MILLI_EXPECT_MOVES(expected) MILLI_DETAIL_EXPECT_UNIQUE(moves, expected)
+
+void* operator new(std::size_t size) {
+  if (void* pointer = milli::test::detail::allocate(size))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return milli::test::detail::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return milli::test::detail::allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  milli::test::detail::deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  milli::test::detail::deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  milli::test::detail::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  milli::test::detail::deallocate(pointer);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* pointer, std::size_t) noexcept {
+  milli::test::detail::deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+  milli::test::detail::deallocate(pointer);
+}
+#endif
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  if (void* pointer = milli::test::detail::allocate(size, alignment))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return milli::test::detail::allocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return milli::test::detail::allocate(size, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+  milli::test::detail::deallocate(pointer, alignment);
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+  milli::test::detail::deallocate(pointer, alignment);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+  milli::test::detail::deallocate(pointer, alignment);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+  milli::test::detail::deallocate(pointer, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  milli::test::detail::deallocate(pointer, alignment);
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  milli::test::detail::deallocate(pointer, alignment);
+}
+#endif
+
+#endif //MILLI_TEST_INSTRUMENTATION_HPP
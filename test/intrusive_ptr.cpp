@@ -0,0 +1,128 @@
+/*
+intrusive_ptr.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/intrusive_ptr.hpp>
+#include <milli/not_empty_e.hpp>
+#include <milli/not_empty_h.hpp>
+
+#define BOOST_TEST_MODULE intrusive_ptr test
+#include <boost/test/included/unit_test.hpp>
+
+using namespace milli;
+
+namespace {
+  struct node : intrusive_ref_counter<node> {
+    explicit node(int& alive) : alive(alive) { ++alive; }
+    node(const node& rhs) : intrusive_ref_counter<node>(rhs), alive(rhs.alive) { ++alive; }
+    ~node() { --alive; }
+    int& alive;
+    intrusive_ptr<node> next;
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(intrusive_ptr_test_suite)
+
+  BOOST_AUTO_TEST_CASE(pointer_is_one_word) {
+    BOOST_TEST(sizeof(intrusive_ptr<node>) == sizeof(node*));
+  }
+
+  BOOST_AUTO_TEST_CASE(copies_share_the_object) {
+    int alive = 0;
+    {
+      auto test = make_intrusive<node>(alive);
+      BOOST_TEST(test->use_count() == 1u);
+      {
+        auto copy = test;
+        intrusive_ptr<node> assigned;
+        assigned = copy;
+        BOOST_TEST(test->use_count() == 3u);
+        BOOST_TEST((assigned == test));
+      }
+      BOOST_TEST(test->use_count() == 1u);
+      BOOST_TEST(alive == 1);
+    }
+    BOOST_TEST(alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(chain_is_released) {
+    int alive = 0;
+    {
+      auto head = make_intrusive<node>(alive);
+      head->next = make_intrusive<node>(alive);
+      head->next->next = make_intrusive<node>(alive);
+      BOOST_TEST(alive == 3);
+    }
+    BOOST_TEST(alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(copied_object_has_own_count) {
+    int alive = 0;
+    auto test = make_intrusive<node>(alive);
+    auto copy = make_intrusive<node>(*test);
+
+    BOOST_TEST(test->use_count() == 1u);
+    BOOST_TEST(copy->use_count() == 1u);
+  }
+
+  BOOST_AUTO_TEST_CASE(detach_and_adopt) {
+    int alive = 0;
+    auto test = make_intrusive<node>(alive);
+    node* raw = test.detach();
+
+    BOOST_TEST(not test);
+    BOOST_TEST(raw->use_count() == 1u);
+
+    intrusive_ptr<node> adopted(raw, false);
+    BOOST_TEST(adopted->use_count() == 1u);
+    adopted.reset();
+    BOOST_TEST(alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(const_pointer) {
+    int alive = 0;
+    auto test = make_intrusive<node>(alive);
+    intrusive_ptr<const node> constant = test;
+
+    BOOST_TEST(test->use_count() == 2u);
+    BOOST_TEST((constant == test));
+  }
+
+  BOOST_AUTO_TEST_CASE(not_empty_integration) {
+    int alive = 0;
+    intrusive_ptr<node> empty;
+    BOOST_CHECK_THROW(not_empty_e<intrusive_ptr<node>> test(empty), milli::value_not_empty);
+
+    {
+      not_empty_h<intrusive_ptr<node>> test(make_intrusive<node>(alive));
+      auto copy = test;
+      BOOST_TEST(copy->use_count() == 2u);
+    }
+    BOOST_TEST(alive == 0);
+  }
+
+#ifdef __cpp_deduction_guides
+
+  BOOST_AUTO_TEST_CASE(deduction_guide) {
+    int alive = 0;
+    not_empty_h test(make_intrusive<node>(alive));
+
+    constexpr bool deduction_type_check = std::is_same<decltype(test), not_empty_h<intrusive_ptr<node>>>::value;
+    BOOST_TEST(deduction_type_check);
+  }
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,152 @@
+/*
+lazy.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/lazy.hpp>
+
+#define BOOST_TEST_MODULE lazy test
+#include <boost/test/included/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace milli;
+
+namespace {
+  std::atomic<int> initializations{0};
+
+  struct counted_table {
+    auto operator()() const -> std::vector<int> {
+      ++initializations;
+      return std::vector<int>{1, 2, 3};
+    }
+  };
+
+  struct fails_first {
+    int* calls;
+
+    auto operator()() const -> std::string {
+      if((*calls)++ == 0)
+        throw std::runtime_error("first call fails");
+      return "second";
+    }
+  };
+
+  // Constant initialized, so it is usable from the dynamic initializer below, whatever the initialization order is.
+  lazy<std::vector<int>, counted_table> global_table;
+  const std::size_t size_during_initialization = global_table->size();
+}
+
+BOOST_AUTO_TEST_SUITE(lazy_test_suite)
+
+  BOOST_AUTO_TEST_CASE(global_is_usable_during_dynamic_initialization) {
+    BOOST_TEST(size_during_initialization == 3u);
+    BOOST_TEST(global_table.initialized());
+  }
+
+  BOOST_AUTO_TEST_CASE(initializes_once_on_first_read) {
+    initializations = 0;
+    lazy<std::vector<int>, counted_table> table;
+    BOOST_TEST(not table.initialized());
+    BOOST_TEST(initializations == 0);
+
+    BOOST_TEST(table->size() == 3u);
+    BOOST_TEST((*table)[1] == 2);
+    BOOST_TEST(&table.get() == &*table);
+    BOOST_TEST(initializations == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(default_init_value_initializes) {
+    lazy<int> number;
+    BOOST_TEST(*number == 0);
+    *number = 5;
+    BOOST_TEST(number.get() == 5);
+  }
+
+  BOOST_AUTO_TEST_CASE(init_may_be_a_lambda_or_function_pointer) {
+    int calls = 0;
+    auto init = [&calls]{ return ++calls * 10; };
+    lazy<int, decltype(init)> from_lambda(init);
+    thread_local_lazy<int, int(*)()> from_pointer([]{ return 7; });
+
+    BOOST_TEST(*from_lambda == 10);
+    BOOST_TEST(*from_lambda == 10);
+    BOOST_TEST(calls == 1);
+    BOOST_TEST(*from_pointer == 7);
+  }
+
+  BOOST_AUTO_TEST_CASE(concurrent_first_reads_initialize_once) {
+    initializations = 0;
+    lazy<std::vector<int>, counted_table> table;
+    std::atomic<bool> start{false};
+    std::vector<const std::vector<int>*> seen(8);
+    std::vector<std::thread> threads;
+    for(std::size_t thread = 0; thread != seen.size(); ++thread)
+      threads.emplace_back([&, thread]{
+        while(not start)
+          std::this_thread::yield();
+        seen[thread] = &table.get();
+      });
+    start = true;
+    for(auto& thread : threads)
+      thread.join();
+
+    BOOST_TEST(initializations == 1);
+    for(auto value : seen)
+      BOOST_TEST(value == &table.get());
+  }
+
+  BOOST_AUTO_TEST_CASE(failed_initialization_is_retried) {
+    int calls = 0;
+    lazy<std::string, fails_first> text(fails_first{&calls});
+
+    BOOST_CHECK_THROW(text.get(), std::runtime_error);
+    BOOST_TEST(not text.initialized());
+    BOOST_TEST(*text == "second");
+    BOOST_TEST(calls == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(reset_initializes_again) {
+    initializations = 0;
+    lazy<std::vector<int>, counted_table> table;
+    table->push_back(4);
+    table.reset();
+    BOOST_TEST(not table.initialized());
+    BOOST_TEST(table->size() == 3u);
+    BOOST_TEST(initializations == 2);
+
+    thread_local_lazy<std::vector<int>, counted_table> local;
+    local->push_back(4);
+    local.reset();
+    BOOST_TEST(local->size() == 3u);
+  }
+
+  BOOST_AUTO_TEST_CASE(thread_local_lazy_initializes_per_thread) {
+    static thread_local thread_local_lazy<std::vector<int>, counted_table> table;
+    initializations = 0;
+    table->push_back(4);
+
+    std::size_t other_size = 0;
+    std::thread([&other_size]{ other_size = table->size(); }).join();
+
+    BOOST_TEST(table->size() == 4u);
+    BOOST_TEST(other_size == 3u);
+    BOOST_TEST(initializations == 2);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+/*
+local_shared_ptr.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/local_shared_ptr.hpp>
+#include <milli/not_empty_e.hpp>
+#include <milli/not_empty_h.hpp>
+
+#define BOOST_TEST_MODULE local_shared_ptr test
+#include <boost/test/included/unit_test.hpp>
+
+#include <string>
+
+using namespace milli;
+
+namespace {
+  struct counted {
+    explicit counted(int& alive) : alive(alive) { ++alive; }
+    virtual ~counted() { --alive; }
+    int& alive;
+  };
+
+  struct derived : counted {
+    using counted::counted;
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(local_shared_ptr_test_suite)
+
+  BOOST_AUTO_TEST_CASE(empty_pointer) {
+    local_shared_ptr<int> test;
+    local_shared_ptr<int> null = nullptr;
+
+    BOOST_TEST(not test);
+    BOOST_TEST((test == nullptr));
+    BOOST_TEST(test.use_count() == 0u);
+    BOOST_TEST((test == null));
+  }
+
+  BOOST_AUTO_TEST_CASE(copies_share_the_object) {
+    int alive = 0;
+    {
+      auto test = make_local_shared<counted>(alive);
+      BOOST_TEST(alive == 1);
+      BOOST_TEST(test.use_count() == 1u);
+      {
+        auto copy = test;
+        local_shared_ptr<counted> assigned;
+        assigned = copy;
+        BOOST_TEST(test.use_count() == 3u);
+        BOOST_TEST((assigned == test));
+      }
+      BOOST_TEST(test.use_count() == 1u);
+      BOOST_TEST(alive == 1);
+    }
+    BOOST_TEST(alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(move_keeps_the_count) {
+    auto test = make_local_shared<std::string>("milli");
+    auto moved = std::move(test);
+
+    BOOST_TEST(not test);
+    BOOST_TEST(moved.use_count() == 1u);
+    BOOST_TEST(*moved == "milli");
+    BOOST_TEST(moved->size() == 5u);
+  }
+
+  BOOST_AUTO_TEST_CASE(self_assignment) {
+    auto test = make_local_shared<int>(7);
+    auto& alias = test;
+    test = alias;
+
+    BOOST_TEST(test.use_count() == 1u);
+    BOOST_TEST(*test == 7);
+  }
+
+  BOOST_AUTO_TEST_CASE(derived_to_base) {
+    int alive = 0;
+    {
+      local_shared_ptr<counted> base = make_local_shared<derived>(alive);
+      auto derived_copy = make_local_shared<derived>(alive);
+      local_shared_ptr<counted> base_copy = derived_copy;
+
+      BOOST_TEST(alive == 2);
+      BOOST_TEST(derived_copy.use_count() == 2u);
+      base.reset();
+      BOOST_TEST(alive == 1);
+    }
+    BOOST_TEST(alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(not_empty_integration) {
+    local_shared_ptr<int> empty;
+    BOOST_CHECK_THROW(not_empty_e<local_shared_ptr<int>> test(empty), milli::value_not_empty);
+
+    not_empty_h<local_shared_ptr<int>> test(make_local_shared<int>(3));
+    auto copy = test;
+    *copy = 4;
+
+    BOOST_TEST(*test == 4);
+    BOOST_TEST(test.get().use_count() == 2u);
+  }
+
+#ifdef __cpp_deduction_guides
+
+  BOOST_AUTO_TEST_CASE(deduction_guide) {
+    not_empty_h test(make_local_shared<int>(1));
+
+    constexpr bool deduction_type_check = std::is_same<decltype(test), not_empty_h<local_shared_ptr<int>>>::value;
+    BOOST_TEST(deduction_type_check);
+  }
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
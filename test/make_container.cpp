@@ -18,6 +18,7 @@ move_initializer_list.cpp: This file is part of the Milli Library.
 
 #include <boost/test/included/unit_test.hpp>
 #include <milli/make_container.hpp>
+#include "instrumentation.hpp"
 #include <algorithm>
 #include <memory>
 #include <vector>
@@ -61,4 +62,36 @@ BOOST_AUTO_TEST_CASE(container_from_initializer_lists) {
   BOOST_TEST(std::equal(container[1].begin(), container[1].end(), valueTwo.begin()));
 }
 
+BOOST_AUTO_TEST_CASE(temporaries_are_moved_into_one_allocation) {
+  using milli::test::counted;
+
+  MILLI_EXPECT_ALLOCS(1) MILLI_EXPECT_COPIES(0) MILLI_EXPECT_MOVES(3) {
+    auto container = milli::make_container<std::vector<counted<int>>>(counted<int>(1), counted<int>(2), counted<int>(3));
+    BOOST_TEST(container.size() == 3);
+    BOOST_TEST(container[2].value() == 3);
+  }
+
+  MILLI_EXPECT_ALLOCS(3) {
+    milli::make_container<std::vector<std::unique_ptr<int>>>(new int(2), new int(3));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(references_are_copied_into_one_allocation) {
+  using milli::test::counted;
+
+  counted<int> a(1);
+  counted<int> b(2);
+  MILLI_EXPECT_ALLOCS(1) MILLI_EXPECT_COPIES(2) MILLI_EXPECT_MOVES(0) {
+    auto container = milli::make_container<std::vector<counted<int>>>(a, b);
+    BOOST_TEST(container.size() == 2);
+    BOOST_TEST(container[0].value() == a.value());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(empty_container_does_not_allocate) {
+  MILLI_EXPECT_ALLOCS(0) {
+    milli::make_container<std::vector<int>>();
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,155 @@
+/*
+make_container_from.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2018-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#define BOOST_TEST_MODULE make_container_from test
+
+#include <boost/test/included/unit_test.hpp>
+#include <milli/make_container_from.hpp>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "instrumentation.hpp"
+
+namespace {
+
+  struct counted{
+    static std::atomic<int> alive;
+
+    explicit counted(std::size_t value) : value(value) { ++alive; }
+    counted(counted&& rhs) noexcept : value(rhs.value) { ++alive; }
+    counted(const counted& rhs) : value(rhs.value) { ++alive; }
+    ~counted() { --alive; }
+
+    std::size_t value;
+  };
+
+  std::atomic<int> counted::alive(0);
+
+  struct no_default{
+    no_default() = delete;
+    explicit no_default(int value) : value(value) {}
+    int value;
+  };
+
+}
+
+BOOST_AUTO_TEST_SUITE(make_container_from_test_suite)
+
+  BOOST_AUTO_TEST_CASE(empty_size) {
+    auto container = milli::make_container_from<std::vector<int>>(0, [](std::size_t i){ return int(i); });
+    BOOST_TEST(container.empty());
+  }
+
+  BOOST_AUTO_TEST_CASE(sequential_from_size) {
+    auto container = milli::make_container_from<std::vector<std::size_t>>(100, [](std::size_t i){ return i * 2; });
+
+    BOOST_TEST(container.size() == 100u);
+    for(std::size_t i = 0; i < container.size(); ++i)
+      BOOST_TEST(container[i] == i * 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(parallel_from_size) {
+    constexpr std::size_t size = 100003;
+    auto container = milli::make_container_from<std::vector<std::size_t>>(size, [](std::size_t i){ return i + 1; },
+                                                                            milli::parallel_policy(4, 16));
+
+    BOOST_TEST(container.size() == size);
+    bool all_matching = true;
+    for(std::size_t i = 0; i < size; ++i)
+      all_matching = all_matching && container[i] == i + 1;
+    BOOST_TEST(all_matching);
+  }
+
+  BOOST_AUTO_TEST_CASE(parallel_from_range) {
+    std::vector<int> source(5000);
+    for(std::size_t i = 0; i < source.size(); ++i)
+      source[i] = int(i);
+
+    auto container = milli::make_container_from<std::deque<std::string>>(source, [](int value){ return std::to_string(value); },
+                                                                           milli::parallel_policy(3, 1));
+
+    BOOST_TEST(container.size() == source.size());
+    BOOST_TEST(container.front() == "0");
+    BOOST_TEST(container.back() == "4999");
+  }
+
+  BOOST_AUTO_TEST_CASE(non_random_access_range) {
+    std::list<int> source = {1, 2, 3};
+    auto container = milli::make_container_from<std::vector<int>>(source, [](int value){ return value * 10; }, milli::par);
+
+    BOOST_TEST(container.size() == 3u);
+    BOOST_TEST(container[0] == 10);
+    BOOST_TEST(container[2] == 30);
+  }
+
+  BOOST_AUTO_TEST_CASE(no_default_construction_required) {
+    auto container = milli::make_container_from<std::vector<no_default>>(10, [](std::size_t i){ return no_default(int(i)); });
+    BOOST_TEST(container[9].value == 9);
+  }
+
+  BOOST_AUTO_TEST_CASE(sequential_build_constructs_in_place) {
+    using element = milli::test::counted<int>;
+    std::vector<element> container;
+    MILLI_EXPECT_ALLOCS(1) MILLI_EXPECT_COPIES(0) MILLI_EXPECT_MOVES(0) {
+      container = milli::make_container_from<std::vector<element>>(100, [](std::size_t i){ return element(int(i)); });
+    }
+    BOOST_TEST(container[99].value() == 99);
+  }
+
+  BOOST_AUTO_TEST_CASE(sequential_exception_leaves_nothing_alive) {
+    auto generator = [](std::size_t i){
+      if(i == 57)
+        throw std::runtime_error("generator failure");
+      return counted(i);
+    };
+
+    BOOST_CHECK_THROW(milli::make_container_from<std::vector<counted>>(100, generator), std::runtime_error);
+    BOOST_TEST(counted::alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(parallel_exception_leaves_nothing_alive) {
+    auto generator = [](std::size_t i){
+      if(i == 5000 || i == 9000)
+        throw std::runtime_error("generator failure");
+      return counted(i);
+    };
+
+    BOOST_CHECK_THROW(milli::make_container_from<std::vector<counted>>(10000, generator, milli::parallel_policy(4, 1)),
+                      std::runtime_error);
+    BOOST_TEST(counted::alive == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(default_init_allocator_container) {
+    using container_type = std::vector<int, milli::default_init_allocator<int>>;
+    auto container = milli::make_container_from<container_type>(20000, [](std::size_t i){ return int(i); },
+                                                                 milli::parallel_policy(2, 1));
+
+    BOOST_TEST(container.size() == 20000u);
+    BOOST_TEST(container[19999] == 19999);
+  }
+
+  BOOST_AUTO_TEST_CASE(move_only_elements) {
+    auto container = milli::make_container_from<std::vector<std::unique_ptr<int>>>(
+        64, [](std::size_t i){ return std::unique_ptr<int>(new int(int(i))); }, milli::parallel_policy(2, 1));
+
+    BOOST_TEST(*container[63] == 63);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
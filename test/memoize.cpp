@@ -0,0 +1,170 @@
+/*
+memoize.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/memoize.hpp>
+
+#define BOOST_TEST_MODULE memoize test
+#include <boost/test/included/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace milli;
+
+BOOST_AUTO_TEST_SUITE(memoize_test_suite)
+
+  BOOST_AUTO_TEST_CASE(results_are_computed_once) {
+    int calls = 0;
+    auto square = memoize<int>([&calls](int value){ ++calls; return static_cast<long>(value) * value; }, 1000);
+
+    for(int round = 0; round != 3; ++round)
+      for(int value = 0; value != 100; ++value)
+        BOOST_TEST(square(value) == static_cast<long>(value) * value);
+
+    BOOST_TEST(calls == 100);
+    BOOST_TEST(square.size() == 100u);
+    BOOST_TEST(square.capacity() >= 1000u);
+  }
+
+  BOOST_AUTO_TEST_CASE(non_trivially_copyable_types_are_cached) {
+    int calls = 0;
+    auto twice = memoize<std::string>([&calls](const std::string& text){ ++calls; return text + text; }, 16, 2);
+
+    BOOST_TEST(twice("ab") == "abab");
+    BOOST_TEST(twice("ab") == "abab");
+    BOOST_TEST(twice(std::string(100, 'x')) == std::string(200, 'x'));
+    BOOST_TEST(calls == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(capacity_bounds_the_size) {
+    auto identity = memoize<int>([](int value){ return value; }, 8, 1);
+    BOOST_TEST(identity.capacity() == 8u);
+
+    for(int value = 0; value != 1000; ++value)
+      BOOST_TEST(identity(value) == value);
+    BOOST_TEST(identity.size() == 8u);
+  }
+
+  BOOST_AUTO_TEST_CASE(eviction_stays_within_the_probe_window) {
+    auto identity = memoize<std::uint64_t>([](std::uint64_t value){ return value; }, 1 << 10, 2);
+
+    // The second call marks every entry as referenced, so evictions need the second round of the CLOCK hand.
+    for(std::uint64_t value = 0; value != 100000; ++value){
+      BOOST_TEST(identity(value) == value);
+      BOOST_TEST(identity(value) == value);
+    }
+    BOOST_TEST(identity.size() == identity.capacity());
+  }
+
+  BOOST_AUTO_TEST_CASE(clock_keeps_entries_that_are_read) {
+    int hot_calls = 0;
+    auto cached = memoize<int>([&hot_calls](int value){
+      if(value == -1)
+        ++hot_calls;
+      return value;
+    }, 8, 1);
+
+    for(int value = 0; value != 1000; ++value){
+      BOOST_TEST(cached(-1) == -1);
+      cached(value);
+    }
+    BOOST_TEST(hot_calls == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(clear_drops_entries) {
+    int calls = 0;
+    auto cached = memoize<int>([&calls](int value){ ++calls; return value; }, 64);
+    cached(1);
+    cached.clear();
+    BOOST_TEST(cached.size() == 0u);
+    cached(1);
+    BOOST_TEST(calls == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(concurrent_misses_call_the_function_once) {
+    std::atomic<int> calls{0};
+    auto slow = memoize<int>([&calls](int value){
+      ++calls;
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      return value + 1;
+    }, 64);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> wrong{0};
+    for(int thread = 0; thread != 8; ++thread)
+      threads.emplace_back([&]{
+        if(slow(41) != 42)
+          ++wrong;
+      });
+    for(auto& thread : threads)
+      thread.join();
+
+    BOOST_TEST(calls == 1);
+    BOOST_TEST(wrong == 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(exceptions_reach_every_waiter_and_are_not_cached) {
+    std::atomic<int> calls{0};
+    auto failing = memoize<int>([&calls](int value) -> int {
+      if(calls++ == 0){
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        throw std::runtime_error("first call fails");
+      }
+      return value;
+    }, 64);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for(int thread = 0; thread != 4; ++thread)
+      threads.emplace_back([&]{
+        try {
+          failing(7);
+        } catch(const std::runtime_error&) {
+          ++failures;
+        }
+      });
+    for(auto& thread : threads)
+      thread.join();
+
+    BOOST_TEST(failures >= 1);
+    BOOST_TEST(failing(7) == 7);
+  }
+
+  BOOST_AUTO_TEST_CASE(concurrent_hits_and_evictions_return_correct_values) {
+    auto cube = memoize<std::uint64_t>([](std::uint64_t value){ return value * value * value; }, 256, 4);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> wrong{0};
+    for(std::uint64_t thread = 0; thread != 4; ++thread)
+      threads.emplace_back([&, thread]{
+        for(std::uint64_t i = 0; i != 20000; ++i){
+          auto value = (i * 7 + thread) % 1024;
+          if(cube(value) != value * value * value)
+            ++wrong;
+        }
+      });
+    for(auto& thread : threads)
+      thread.join();
+
+    BOOST_TEST(wrong == 0);
+    BOOST_TEST(cube.size() <= cube.capacity());
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
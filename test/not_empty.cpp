@@ -21,6 +21,22 @@ not_empty.cpp: This file is part of the Milli Library.
 
 #define BOOST_TEST_MODULE not_empty test
 #include <boost/test/included/unit_test.hpp>
+#include "instrumentation.hpp"
+
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<optional>)
+#include <optional>
+#endif
+#if __has_include(<string_view>)
+#include <string_view>
+#endif
+#endif
 
 
 using namespace milli;
@@ -92,6 +108,12 @@ BOOST_AUTO_TEST_SUITE(not_empty_test_suite)
     BOOST_TEST(not my_test);
   }
 
+  BOOST_AUTO_TEST_CASE(const_member_access) {
+    const not_empty_e<std::unique_ptr<std::pair<int, int>>> test(std::unique_ptr<std::pair<int, int>>(new std::pair<int, int>(1, 2)));
+
+    BOOST_TEST(test->second == 2);
+  }
+
 #ifdef __cpp_lib_optional
 
   BOOST_AUTO_TEST_CASE(optional_empty_type_test) {
@@ -286,4 +308,208 @@ BOOST_AUTO_TEST_SUITE(not_empty_test_suite)
     BOOST_TEST(test->function() == 1);
   }
 
+  BOOST_AUTO_TEST_CASE(check_once_policy) {
+    int* null = nullptr;
+    BOOST_CHECK_THROW((not_empty_e<int*, check_once>(null)), milli::value_not_empty);
+
+    int value = 1;
+    not_empty_e<int*, check_once> test(&value);
+    *test = 2;
+    BOOST_TEST(value == 2);
+    BOOST_TEST(test.get() == &value);
+
+    constexpr bool noexcept_dereference = noexcept(*test);
+    constexpr bool noexcept_get = noexcept(test.get());
+    BOOST_TEST(noexcept_dereference);
+    BOOST_TEST(noexcept_get);
+
+    struct Foo{
+      int function(){return 3;}
+    };
+
+    not_empty_h<std::shared_ptr<Foo>, check_once> shared(std::make_shared<Foo>());
+    BOOST_TEST(shared->function() == 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(assignment_checks_the_assigned_value) {
+    not_empty_e<std::unique_ptr<int>, check_once> source(std::unique_ptr<int>(new int(1)));
+    not_empty_e<std::unique_ptr<int>, check_once> target(std::unique_ptr<int>(new int(2)));
+    auto owner = std::move(source);
+    BOOST_CHECK_THROW(target = std::move(source), milli::value_not_empty);
+    BOOST_CHECK_THROW(target.assign(std::move(source)), milli::value_not_empty);
+    BOOST_TEST(*owner == 1);
+    BOOST_TEST(*target == 2);
+
+    not_empty_h<std::shared_ptr<int>, check_once> other_flavour(std::make_shared<int>(3));
+    not_empty_e<std::shared_ptr<int>, check_once> shared(std::make_shared<int>(4));
+    auto keeper = std::move(other_flavour);
+    BOOST_CHECK_THROW(shared = other_flavour, milli::value_not_empty);
+    BOOST_CHECK_THROW(shared = std::move(other_flavour), milli::value_not_empty);
+    BOOST_TEST(*shared == 4);
+
+    shared = keeper;
+    BOOST_TEST(*shared == 3);
+    not_empty_base<std::shared_ptr<int>, milli::detail::exception_error_handler, check_once>& base = shared;
+    base = not_empty_h<std::shared_ptr<int>>(std::make_shared<int>(5));
+    BOOST_TEST(*shared == 5);
+  }
+
+  BOOST_AUTO_TEST_CASE(wrapping_does_not_allocate) {
+    int value = 1;
+    auto shared = std::make_shared<int>(2);
+    MILLI_EXPECT_ALLOCS(0) {
+      not_empty_e<int*> pointer(&value);
+      not_empty_h<std::shared_ptr<int>, check_once> owner(std::move(shared));
+      auto copy = owner;
+      BOOST_TEST(*pointer + *copy == 3);
+    }
+
+    auto unique = std::unique_ptr<int>(new int(3));
+    MILLI_EXPECT_ALLOCS(0) {
+      not_empty_e<std::unique_ptr<int>> owner(std::move(unique));
+      BOOST_TEST(*owner == 3);
+    }
+  }
+
+#ifdef __cpp_lib_optional
+
+  BOOST_AUTO_TEST_CASE(wrapping_moves_without_copies) {
+    using milli::test::counted;
+
+    std::optional<counted<int>> value(counted<int>(4));
+    MILLI_EXPECT_COPIES(0) MILLI_EXPECT_MOVES(1) {
+      not_empty_e<std::optional<counted<int>>> wrapped(std::move(value));
+      BOOST_TEST((*wrapped).value() == 4);
+    }
+  }
+
+#endif
+
+  BOOST_AUTO_TEST_CASE(comparisons_use_stored_values) {
+    int values[2] = {1, 2};
+    not_empty_i<int*> first(&values[0]);
+    not_empty_h<int*, check_once> also_first(&values[0]);
+    not_empty_e<int*> second(&values[1]);
+
+    BOOST_TEST((first == also_first));
+    BOOST_TEST((first != second));
+    BOOST_TEST((first < second));
+    BOOST_TEST((second >= also_first));
+    BOOST_TEST((first == &values[0]));
+    BOOST_TEST((&values[1] == second));
+    BOOST_TEST((first != nullptr));
+
+    auto shared = std::make_shared<int>(3);
+    not_empty_h<std::shared_ptr<int>> owner(shared);
+    BOOST_TEST((owner == shared));
+    BOOST_TEST((shared == owner));
+  }
+
+  BOOST_AUTO_TEST_CASE(std_hash_is_the_hash_of_the_stored_value) {
+    int value = 1;
+    auto shared = std::make_shared<int>(2);
+    BOOST_TEST(std::hash<not_empty_i<int*>>()(not_empty_i<int*>(&value)) == std::hash<int*>()(&value));
+    BOOST_TEST(std::hash<not_empty_h<std::shared_ptr<int>>>()(not_empty_h<std::shared_ptr<int>>(shared)) ==
+               std::hash<int*>()(shared.get()));
+
+    std::unordered_set<not_empty_e<int*>> set;
+    set.insert(not_empty_e<int*>(&value));
+    BOOST_TEST(set.count(not_empty_e<int*>(&value)) == 1u);
+  }
+
+  BOOST_AUTO_TEST_CASE(transparent_functions_unwrap_keys) {
+    int value = 1;
+    auto shared = std::make_shared<int>(2);
+    not_empty_h<std::shared_ptr<int>> owner(shared);
+
+    BOOST_TEST(not_empty_hash()(owner) == not_empty_hash()(shared.get()));
+    BOOST_TEST(not_empty_hash()(shared) == not_empty_hash()(shared.get()));
+    BOOST_TEST(not_empty_equal_to()(owner, shared.get()));
+    BOOST_TEST(not not_empty_equal_to()(owner, &value));
+    BOOST_TEST(not_empty_less()(owner, shared.get()) == std::less<int*>()(shared.get(), shared.get()));
+  }
+
+#ifdef __cpp_lib_optional
+
+  BOOST_AUTO_TEST_CASE(wrapped_optionals_are_keyed_by_their_value) {
+    using key = not_empty_h<std::optional<int>>;
+    BOOST_TEST(std::hash<key>()(key(std::optional<int>(3))) == std::hash<int>()(3));
+    BOOST_TEST(not_empty_equal_to()(key(std::optional<int>(3)), 3));
+
+    std::set<key, not_empty_less> ordered;
+    ordered.insert(key(std::optional<int>(3)));
+    BOOST_TEST(ordered.count(3) == 1u);
+    BOOST_TEST(ordered.count(4) == 0u);
+
+#ifdef __cpp_lib_generic_unordered_lookup
+    std::unordered_set<key, not_empty_hash, not_empty_equal_to> unordered;
+    unordered.insert(key(std::optional<int>(3)));
+    BOOST_TEST(unordered.count(3) == 1u);
+#endif
+  }
+
+#endif
+
+#ifdef __cpp_lib_string_view
+
+  BOOST_AUTO_TEST_CASE(character_pointers_are_keyed_by_their_text) {
+    using key = not_empty_i<const char*>;
+    char buffer[] = "key";
+    const std::string text = "key";
+
+    std::set<key, not_empty_less> ordered;
+    ordered.insert(key(buffer));
+    MILLI_EXPECT_ALLOCS(0) {
+      BOOST_TEST(ordered.count("key") == 1u);
+      BOOST_TEST(ordered.count(std::string_view("key")) == 1u);
+      BOOST_TEST(ordered.count(text) == 1u);
+      BOOST_TEST(ordered.count("other") == 0u);
+    }
+    BOOST_TEST(std::hash<key>()(key(buffer)) == std::hash<std::string_view>()("key"));
+
+#ifdef __cpp_lib_generic_unordered_lookup
+    std::unordered_set<key, not_empty_hash, not_empty_equal_to> unordered;
+    unordered.insert(key(buffer));
+    MILLI_EXPECT_ALLOCS(0) {
+      BOOST_TEST(unordered.count("key") == 1u);
+      BOOST_TEST(unordered.count(std::string_view("key")) == 1u);
+      BOOST_TEST(unordered.count(text) == 1u);
+      BOOST_TEST(unordered.count("other") == 0u);
+    }
+#endif
+  }
+
+#endif
+
+#ifdef __cpp_lib_generic_associative_lookup
+
+  BOOST_AUTO_TEST_CASE(ordered_lookup_without_wrappers) {
+    auto shared = std::make_shared<int>(1);
+    std::set<not_empty_h<std::shared_ptr<int>>, not_empty_less> set;
+    set.insert(not_empty_h<std::shared_ptr<int>>(shared));
+
+    MILLI_EXPECT_ALLOCS(0) {
+      BOOST_TEST(set.count(shared.get()) == 1u);
+      // A temporary not_empty_h would terminate here.
+      BOOST_TEST(set.count(static_cast<int*>(nullptr)) == 0u);
+    }
+  }
+
+#endif
+
+#ifdef __cpp_lib_generic_unordered_lookup
+
+  BOOST_AUTO_TEST_CASE(unordered_lookup_without_wrappers) {
+    auto shared = std::make_shared<int>(1);
+    std::unordered_set<not_empty_h<std::shared_ptr<int>>, not_empty_hash, not_empty_equal_to> set;
+    set.insert(not_empty_h<std::shared_ptr<int>>(shared));
+
+    MILLI_EXPECT_ALLOCS(0) {
+      BOOST_TEST(set.count(shared.get()) == 1u);
+      BOOST_TEST(set.count(static_cast<int*>(nullptr)) == 0u);
+    }
+  }
+
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
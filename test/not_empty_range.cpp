@@ -0,0 +1,151 @@
+/*
+not_empty_range.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/not_empty_range.hpp>
+
+#define BOOST_TEST_MODULE not_empty_range test
+#include <boost/test/included/unit_test.hpp>
+
+#include <list>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace milli;
+
+BOOST_AUTO_TEST_SUITE(not_empty_range_test_suite)
+
+  BOOST_AUTO_TEST_CASE(no_default_constructor) {
+    constexpr bool is_default_constructible = std::is_default_constructible<not_empty_range_e<std::vector<int>>>::value;
+    BOOST_TEST(is_default_constructible == false);
+  }
+
+  BOOST_AUTO_TEST_CASE(empty_range_initialization_fails) {
+    std::vector<int> empty;
+    BOOST_CHECK_THROW(not_empty_range_e<std::vector<int>> test(empty), milli::value_not_empty);
+    BOOST_CHECK_THROW(not_empty_range_e<std::string> test(""), milli::value_not_empty);
+  }
+
+  BOOST_AUTO_TEST_CASE(empty_range_assignment_fails) {
+    not_empty_range_e<std::vector<int>> test(std::vector<int>{1, 2});
+    BOOST_CHECK_THROW(test = std::vector<int>(), milli::value_not_empty);
+    BOOST_TEST(test.size() == 2u);
+
+    test = std::vector<int>{3};
+    BOOST_TEST(test.front() == 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(front_and_back) {
+    not_empty_range_h<std::vector<int>> test(std::vector<int>{4, 5, 6});
+
+    BOOST_TEST(test.front() == 4);
+    BOOST_TEST(test.back() == 6);
+    BOOST_TEST(test[1] == 5);
+    BOOST_TEST(test.size() == 3u);
+    BOOST_TEST(not test.empty());
+
+    test.front() = 7;
+    BOOST_TEST(test.get()[0] == 7);
+  }
+
+  BOOST_AUTO_TEST_CASE(min_and_max) {
+    const not_empty_range_i<std::list<int>> test(std::list<int>{3, 1, 4, 1, 5});
+
+    BOOST_TEST(test.min() == 1);
+    BOOST_TEST(test.max() == 5);
+    BOOST_TEST(&test.min() == &*std::next(test.begin()));
+
+    auto greater = [](int lhs, int rhs){ return lhs > rhs; };
+    BOOST_TEST(test.min(greater) == 5);
+    BOOST_TEST(test.max(greater) == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(single_element) {
+    not_empty_range_d<std::vector<int>> test(std::vector<int>{42});
+
+    BOOST_TEST(test.min() == 42);
+    BOOST_TEST(test.max() == 42);
+    BOOST_TEST(&test.front() == &test.back());
+  }
+
+  BOOST_AUTO_TEST_CASE(for_each_visits_every_element) {
+    not_empty_range_e<std::vector<int>> test(std::vector<int>{1, 2, 3});
+
+    int sum = 0;
+    test.for_each([&sum](int value){ sum += value; });
+    BOOST_TEST(sum == 6);
+
+    test.for_each([](int& value){ value *= 2; });
+    BOOST_TEST(test.back() == 6);
+  }
+
+  BOOST_AUTO_TEST_CASE(range_for) {
+    not_empty_range_e<std::vector<int>> test(std::vector<int>{1, 2, 3});
+
+    int sum = 0;
+    for(int value : test)
+      sum += value;
+    BOOST_TEST(sum == 6);
+  }
+
+  BOOST_AUTO_TEST_CASE(copy_does_not_recheck) {
+    not_empty_range_e<std::vector<int>> test(std::vector<int>{1});
+    not_empty_range_e<std::vector<int>> copy(test);
+    copy = test;
+
+    constexpr bool nothrow_move = std::is_nothrow_move_constructible<not_empty_range_e<std::vector<int>>>::value;
+    BOOST_TEST(nothrow_move);
+  }
+
+#ifdef __cpp_lib_string_view
+
+  BOOST_AUTO_TEST_CASE(string_view_variant) {
+    not_empty_string_view test("milli");
+
+    BOOST_TEST(test.front() == 'm');
+    BOOST_TEST(test.back() == 'i');
+    BOOST_TEST(test.max() == 'm');
+    BOOST_TEST(test.min() == 'i');
+  }
+
+#endif
+
+#ifdef __cpp_deduction_guides
+
+  BOOST_AUTO_TEST_CASE(deduction_guide) {
+    not_empty_range test(std::vector<int>{1});
+
+    constexpr bool deduction_type_check = std::is_same<decltype(test), not_empty_range<std::vector<int>>>::value;
+    BOOST_TEST(deduction_type_check);
+  }
+
+#endif
+
+#ifdef __cpp_lib_string_view
+
+  BOOST_AUTO_TEST_CASE(string_view_keys) {
+    std::unordered_set<not_empty_string_view> set;
+    set.insert(not_empty_string_view(std::string_view("key")));
+    BOOST_TEST(set.count(not_empty_string_view(std::string_view("key"))) == 1u);
+    BOOST_TEST(std::hash<not_empty_string_view>()(std::string_view("key")) == std::hash<std::string_view>()("key"));
+    BOOST_TEST(not_empty_hash()(not_empty_string_view(std::string_view("key"))) ==
+               not_empty_hash()(std::string_view("key")));
+    BOOST_TEST(not_empty_equal_to()(not_empty_string_view(std::string_view("key")), std::string_view("key")));
+  }
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+/*
+not_empty_span.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/not_empty_span.hpp>
+
+#define BOOST_TEST_MODULE not_empty_span test
+#include <boost/test/included/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace milli;
+
+BOOST_AUTO_TEST_SUITE(not_empty_span_test_suite)
+
+  BOOST_AUTO_TEST_CASE(no_default_constructor) {
+    constexpr bool is_default_constructible = std::is_default_constructible<not_empty_span_e<int*>>::value;
+    BOOST_TEST(is_default_constructible == false);
+  }
+
+  BOOST_AUTO_TEST_CASE(find_null_every_position) {
+    int value = 0;
+    for(std::size_t size = 0; size < 40; ++size){
+      std::vector<int*> pointers(size, &value);
+      BOOST_TEST(detail::find_null(pointers.data(), size) == size);
+
+      for(std::size_t null_at = 0; null_at < size; ++null_at){
+        pointers[null_at] = nullptr;
+        BOOST_TEST(detail::find_null(pointers.data(), size) == null_at);
+        if(null_at + 1 < size){
+          pointers[size - 1] = nullptr;
+          BOOST_TEST(detail::find_null(pointers.data(), size) == null_at);
+          pointers[size - 1] = &value;
+        }
+        pointers[null_at] = &value;
+      }
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(valid_array) {
+    int values[20] = {};
+    std::vector<int*> pointers;
+    for(auto& value : values)
+      pointers.push_back(&value);
+
+    not_empty_span_e<int*> test(pointers.data(), pointers.size());
+
+    BOOST_TEST(test.size() == 20u);
+    BOOST_TEST(test[3] == &values[3]);
+    BOOST_TEST(test.front() == &values[0]);
+    BOOST_TEST(test.back() == &values[19]);
+
+    *test.at(5) = 5;
+    BOOST_TEST(values[5] == 5);
+
+    std::size_t visited = 0;
+    for(int* pointer : test)
+      visited += pointer != nullptr;
+    BOOST_TEST(visited == 20u);
+  }
+
+  BOOST_AUTO_TEST_CASE(null_element_throws_with_index) {
+    int value = 0;
+    std::vector<const int*> pointers(17, &value);
+    pointers[13] = nullptr;
+
+    try{
+      not_empty_span_e<const int*> test(pointers.data(), pointers.size());
+      BOOST_FAIL("null element not reported");
+    } catch(const value_not_empty& error){
+      BOOST_TEST(std::string(error.what()).find("13") != std::string::npos);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(from_array) {
+    int first = 1;
+    int second = 2;
+    int* pointers[] = {&first, &second};
+
+    not_empty_span_h<int*> test(pointers);
+    BOOST_TEST(*test[1] == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(empty_span_is_valid) {
+    not_empty_span_e<int*> test(nullptr, 0);
+    BOOST_TEST(test.empty());
+    BOOST_TEST(test.begin() == test.end());
+  }
+
+  BOOST_AUTO_TEST_CASE(noexceptness) {
+    constexpr bool hard_noexcept = std::is_nothrow_constructible<not_empty_span_h<int*>, int* const*, std::size_t>::value;
+    constexpr bool exception_noexcept = std::is_nothrow_constructible<not_empty_span_e<int*>, int* const*, std::size_t>::value;
+
+    BOOST_TEST(hard_noexcept);
+    BOOST_TEST(not exception_noexcept);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,118 @@
+/*
+not_empty_t.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/not_empty_t.hpp>
+
+#define BOOST_TEST_MODULE not_empty_t test
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace milli;
+
+namespace {
+  auto count_at(unsigned line) -> std::uint64_t {
+    std::uint64_t result = 0;
+    for(auto& violation : not_empty_telemetry::snapshot()){
+      if(violation.site.line == line && std::strstr(violation.site.file, "not_empty_t.cpp"))
+        result += violation.count;
+    }
+    return result;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(not_empty_t_test_suite)
+
+  BOOST_AUTO_TEST_CASE(valid_value_is_not_recorded) {
+    int value = 1;
+    auto before = not_empty_telemetry::snapshot().size();
+    not_empty_t<int*> test(&value);
+
+    BOOST_TEST(*test == 1);
+    BOOST_TEST(not_empty_telemetry::snapshot().size() == before);
+  }
+
+  BOOST_AUTO_TEST_CASE(violation_is_recorded_at_call_site) {
+    int* empty = nullptr;
+    unsigned line = 0;
+    for(int index = 0; index != 3; ++index){
+      line = __LINE__ + 1;
+      not_empty_t<int*> test(empty);
+      BOOST_TEST(test.get() == nullptr);
+    }
+
+    BOOST_TEST(count_at(line) == 3u);
+  }
+
+  BOOST_AUTO_TEST_CASE(assign_records_its_call_site) {
+    int* empty = nullptr;
+    int value = 1;
+    not_empty_t<int*> source(empty);
+    not_empty_t<int*> target(&value);
+    const unsigned line = __LINE__ + 1;
+    target.assign(source);
+
+    BOOST_TEST(count_at(line) == 1u);
+  }
+
+  BOOST_AUTO_TEST_CASE(counts_from_all_threads_are_summed) {
+    const unsigned line = __LINE__ + 4;
+    std::vector<std::thread> threads;
+    for(int index = 0; index != 4; ++index){
+      threads.emplace_back([]{
+        for(int repeat = 0; repeat != 100; ++repeat) { not_empty_t<std::shared_ptr<int>> test{std::shared_ptr<int>()}; }
+      });
+    }
+    for(auto& thread : threads)
+      thread.join();
+
+    BOOST_TEST(count_at(line) == 400u);
+  }
+
+  BOOST_AUTO_TEST_CASE(prometheus_text) {
+    std::unique_ptr<int> empty;
+    const unsigned line = __LINE__ + 1;
+    not_empty_t<std::unique_ptr<int>> test(std::move(empty));
+
+    auto text = not_empty_telemetry::prometheus_text();
+    auto sample = "not_empty_t.cpp\",line=\"" + std::to_string(line) + "\"";
+
+    BOOST_TEST(text.find("# TYPE milli_not_empty_violations_total counter\n") != std::string::npos);
+    BOOST_TEST(text.find(sample) != std::string::npos);
+  }
+
+  BOOST_AUTO_TEST_CASE(handler_is_noexcept) {
+    constexpr bool is_nothrow = std::is_nothrow_constructible<not_empty_t<int*>, int*>::value;
+    BOOST_TEST(is_nothrow);
+  }
+
+#ifdef __cpp_deduction_guides
+
+  BOOST_AUTO_TEST_CASE(deduction_guide) {
+    int value = 0;
+    not_empty_t test(&value);
+
+    constexpr bool deduction_type_check = std::is_same<decltype(test), not_empty_t<int*>>::value;
+    BOOST_TEST(deduction_type_check);
+  }
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
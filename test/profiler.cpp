@@ -0,0 +1,142 @@
+/*
+profiler.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/profiler.hpp>
+
+#define BOOST_TEST_MODULE profiler test
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace milli;
+
+namespace {
+  auto profiled_work(int value) -> int {
+    MILLI_PROFILE_SCOPE("profiled_work");
+    return value * 3;
+  }
+
+  auto find_scope(const char* name) -> profile_scope {
+    for(auto& scope : profiler::snapshot())
+      if(std::strcmp(scope.name, name) == 0)
+        return scope;
+    BOOST_FAIL("scope not found");
+    return profile_scope{};
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(profiler_test_suite)
+
+  BOOST_AUTO_TEST_CASE(buckets_cover_values_with_bounded_error) {
+    std::vector<std::uint64_t> values{0, 1, 15, 16, 31, 32, 33, 47, 48, 1000, 123456789, ~std::uint64_t(0)};
+    for(std::uint64_t shift = 0; shift != 64; ++shift)
+      values.push_back(std::uint64_t(1) << shift);
+
+    const std::size_t bucket_count = latency_histogram::bucket_count;
+    for(auto value : values){
+      auto bucket = latency_histogram::bucket(value);
+      BOOST_TEST(bucket < bucket_count);
+      BOOST_TEST(latency_histogram::bucket_upper(bucket) >= value);
+      if(bucket != 0)
+        BOOST_TEST(latency_histogram::bucket_upper(bucket - 1) < value);
+      BOOST_TEST(latency_histogram::bucket_upper(bucket) - value <= value / 16);
+    }
+    BOOST_TEST(latency_histogram::bucket(~std::uint64_t(0)) == bucket_count - 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(percentiles_of_known_values) {
+    latency_histogram histogram;
+    BOOST_TEST(histogram.percentile(0.5) == 0u);
+
+    for(std::uint64_t value = 1; value <= 1000; ++value)
+      histogram.record(value);
+
+    BOOST_TEST(histogram.count() == 1000u);
+    BOOST_TEST(histogram.total() == 500500u);
+    BOOST_TEST(histogram.maximum() == 1000u);
+    BOOST_TEST(histogram.percentile(0.5) >= 500u);
+    BOOST_TEST(histogram.percentile(0.5) <= 500u + 500u / 16);
+    BOOST_TEST(histogram.percentile(0.99) >= 990u);
+    BOOST_TEST(histogram.percentile(1.0) == 1000u);
+    BOOST_TEST(histogram.percentile(0.0) == 1u);
+  }
+
+  BOOST_AUTO_TEST_CASE(merge_adds_counts) {
+    latency_histogram lhs;
+    latency_histogram rhs;
+    lhs.record(10, 3);
+    rhs.record(2000);
+
+    lhs.merge(rhs);
+    BOOST_TEST(lhs.count() == 4u);
+    BOOST_TEST(lhs.total() == 2030u);
+    BOOST_TEST(lhs.maximum() == 2000u);
+    BOOST_TEST(lhs.percentile(0.75) == 10u);
+  }
+
+  BOOST_AUTO_TEST_CASE(scopes_of_all_threads_are_merged) {
+    std::vector<std::thread> threads;
+    for(int thread = 0; thread != 4; ++thread)
+      threads.emplace_back([]{
+        for(int i = 0; i != 100; ++i)
+          profiled_work(i);
+      });
+    for(auto& thread : threads)
+      thread.join();
+
+    auto scope = find_scope("profiled_work");
+    BOOST_TEST(scope.ticks.count() == 400u);
+    BOOST_TEST(scope.line == 31u);
+    BOOST_TEST(scope.nanoseconds_per_tick > 0.0);
+    BOOST_TEST(scope.percentile(0.5) <= scope.maximum());
+    BOOST_TEST(scope.mean() <= scope.maximum());
+  }
+
+  BOOST_AUTO_TEST_CASE(nested_scopes_are_measured_separately) {
+    {
+      MILLI_PROFILE_SCOPE("outer \"scope\"");
+      for(int i = 0; i != 10; ++i){
+        MILLI_PROFILE_SCOPE("inner");
+        profiled_work(i);
+      }
+    }
+
+    BOOST_TEST(find_scope("outer \"scope\"").ticks.count() == 1u);
+    BOOST_TEST(find_scope("inner").ticks.count() == 10u);
+    BOOST_TEST(find_scope("outer \"scope\"").ticks.maximum() >= find_scope("inner").ticks.maximum());
+  }
+
+  BOOST_AUTO_TEST_CASE(json_lists_every_scope) {
+    auto json = profiler::json();
+    BOOST_TEST(json.find("{\"unit\":\"ns\",\"scopes\":[") == 0u);
+    BOOST_TEST(json.find("{\"name\":\"profiled_work\",\"file\":") != std::string::npos);
+    BOOST_TEST(json.find("\"count\":410,\"mean\":") != std::string::npos);
+    BOOST_TEST(json.find("\"name\":\"outer \\\"scope\\\"\"") != std::string::npos);
+    BOOST_TEST(json.find("\"p99.9\":") != std::string::npos);
+    BOOST_TEST(json.substr(json.size() - 2) == "]}");
+  }
+
+  BOOST_AUTO_TEST_CASE(chrome_trace_has_complete_events) {
+    auto trace = profiler::chrome_trace();
+    BOOST_TEST(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[{\"name\":") == 0u);
+    BOOST_TEST(trace.find("{\"name\":\"inner\",\"cat\":\"milli\",\"ph\":\"X\",\"pid\":1,\"tid\":") != std::string::npos);
+    BOOST_TEST(trace.substr(trace.size() - 2) == "]}");
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
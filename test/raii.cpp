@@ -20,6 +20,8 @@ raii.cpp: This file is part of the Milli Library.
 #include <milli/raii.hpp>
 #include <milli/strong_assert.hpp>
 #include <functional>
+#include <utility>
+#include "instrumentation.hpp"
 
 using namespace milli;
 
@@ -80,4 +82,29 @@ BOOST_AUTO_TEST_SUITE(raii_test_suite)
   }
 #endif
 
+  BOOST_AUTO_TEST_CASE(raii_does_not_allocate){
+    int test = 0;
+    auto increment = [&test](){++test;};
+    MILLI_EXPECT_ALLOCS(0) {
+      raii<decltype(increment)> guard(std::move(increment));
+    }
+    BOOST_TEST(test == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(raii_moves_finalizer_once){
+    struct finalizer {
+      milli::test::counted<int*> calls;
+
+      void operator()() {
+        ++*calls.value();
+      }
+    };
+
+    int test = 0;
+    MILLI_EXPECT_COPIES(0) MILLI_EXPECT_MOVES(1) {
+      raii<finalizer> guard(finalizer{&test});
+    }
+    BOOST_TEST(test == 1);
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
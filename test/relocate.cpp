@@ -0,0 +1,185 @@
+/*
+relocate.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <milli/not_empty_h.hpp>
+#include <milli/not_empty_i.hpp>
+#include <milli/optional.hpp>
+#include <milli/raii.hpp>
+#include <milli/relocate.hpp>
+
+#define BOOST_TEST_MODULE relocate test
+#include <boost/test/included/unit_test.hpp>
+#include "instrumentation.hpp"
+
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+
+using namespace milli;
+
+namespace {
+
+  struct relocatable_counted : test::counted<int> {
+    using trivially_relocatable = trivially_relocatable_as<relocatable_counted, true>;
+    using test::counted<int>::counted;
+  };
+
+  // Inherits the opt-in of not_empty_i, but a std::string may point into itself.
+  struct named : not_empty_i<int*> {
+    using not_empty_i<int*>::not_empty_i;
+
+    std::string name;
+  };
+
+  struct self_referencing {
+    self_referencing() : self(this) {}
+    self_referencing(const self_referencing&) : self(this) {}
+
+    self_referencing* self;
+  };
+
+  // Uninitialized storage for count objects of type T.
+  template<typename T, std::size_t count>
+  struct storage {
+    auto data() noexcept -> T* {
+      return reinterpret_cast<T*>(&bytes);
+    }
+
+    typename std::aligned_storage<sizeof(T) * count, alignof(T)>::type bytes;
+  };
+
+}
+
+BOOST_AUTO_TEST_SUITE(relocate_test_suite)
+
+  BOOST_AUTO_TEST_CASE(trivially_copyable_types_are_relocatable) {
+    BOOST_TEST(is_trivially_relocatable<int>::value);
+    BOOST_TEST(is_trivially_relocatable<const int*>::value);
+    BOOST_TEST(not is_trivially_relocatable<self_referencing>::value);
+  }
+
+  BOOST_AUTO_TEST_CASE(smart_pointers_are_relocatable) {
+    BOOST_TEST(is_trivially_relocatable<std::unique_ptr<int>>::value);
+    BOOST_TEST(is_trivially_relocatable<std::shared_ptr<int>>::value);
+    BOOST_TEST(is_trivially_relocatable<const std::weak_ptr<int>>::value);
+  }
+
+  BOOST_AUTO_TEST_CASE(wrappers_are_relocatable_when_their_values_are) {
+    BOOST_TEST(is_trivially_relocatable<not_empty_h<std::unique_ptr<int>>>::value);
+    BOOST_TEST((is_trivially_relocatable<not_empty_h<int*, check_once>>::value));
+    BOOST_TEST(is_trivially_relocatable<detail::optional<std::unique_ptr<int>>>::value);
+    BOOST_TEST(not is_trivially_relocatable<detail::optional<self_referencing>>::value);
+
+    auto finalizer = []() {};
+    BOOST_TEST(is_trivially_relocatable<raii<decltype(finalizer)>>::value);
+    BOOST_TEST(not is_trivially_relocatable<raii<std::function<void()>>>::value);
+  }
+
+  BOOST_AUTO_TEST_CASE(classes_opt_in_with_a_member) {
+    BOOST_TEST(is_trivially_relocatable<relocatable_counted>::value);
+    BOOST_TEST(not is_trivially_relocatable<test::counted<int>>::value);
+  }
+
+  BOOST_AUTO_TEST_CASE(derived_classes_do_not_inherit_the_opt_in) {
+    BOOST_TEST(is_trivially_relocatable<not_empty_i<int*>>::value);
+    BOOST_TEST(not is_trivially_relocatable<named>::value);
+  }
+
+  BOOST_AUTO_TEST_CASE(relocatable_objects_are_copied_as_bytes) {
+    storage<relocatable_counted, 3> source;
+    storage<relocatable_counted, 3> destination;
+    for (int i = 0; i != 3; ++i)
+      ::new(source.data() + i) relocatable_counted(i);
+
+    MILLI_EXPECT_COPIES(0) MILLI_EXPECT_MOVES(0) {
+      test::measurement destructions;
+      auto end = uninitialized_relocate(source.data(), source.data() + 3, destination.data());
+      BOOST_TEST(destructions.destructions() == 0u);
+      BOOST_TEST(end == destination.data() + 3);
+    }
+
+    for (int i = 0; i != 3; ++i) {
+      BOOST_TEST(destination.data()[i].value() == i);
+      destination.data()[i].~relocatable_counted();
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(other_objects_are_moved_and_destroyed) {
+    storage<test::counted<int>, 3> source;
+    storage<test::counted<int>, 3> destination;
+    for (int i = 0; i != 3; ++i)
+      ::new(source.data() + i) test::counted<int>(i);
+
+    MILLI_EXPECT_COPIES(0) MILLI_EXPECT_MOVES(3) {
+      test::measurement destructions;
+      uninitialized_relocate(source.data(), source.data() + 3, destination.data());
+      BOOST_TEST(destructions.destructions() == 3u);
+    }
+
+    for (int i = 0; i != 3; ++i) {
+      BOOST_TEST(destination.data()[i].value() == i);
+      destination.data()[i].~counted();
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(overlapping_relocation_closes_a_gap) {
+    using element = not_empty_h<std::unique_ptr<int>>;
+    storage<element, 4> elements;
+    for (int i = 0; i != 4; ++i)
+      ::new(elements.data() + i) element(std::unique_ptr<int>(new int(i)));
+
+    elements.data()[1].~element();
+    MILLI_EXPECT_ALLOCS(0) {
+      auto end = uninitialized_relocate(elements.data() + 2, elements.data() + 4, elements.data() + 1);
+      BOOST_TEST(end == elements.data() + 3);
+    }
+
+    BOOST_TEST(*elements.data()[0] == 0);
+    BOOST_TEST(*elements.data()[1] == 2);
+    BOOST_TEST(*elements.data()[2] == 3);
+    for (int i = 0; i != 3; ++i)
+      elements.data()[i].~element();
+  }
+
+  BOOST_AUTO_TEST_CASE(relocated_raii_finalizes_once) {
+    int calls = 0;
+    auto finalizer = [&calls]() { ++calls; };
+    using guard = raii<decltype(finalizer)>;
+
+    storage<guard, 1> source;
+    storage<guard, 1> destination;
+    ::new(source.data()) guard(std::move(finalizer));
+    auto relocated = relocate(source.data(), destination.data());
+    BOOST_TEST(relocated == destination.data());
+    BOOST_TEST(calls == 0);
+
+    relocated->~guard();
+    BOOST_TEST(calls == 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(noexcept_relocation) {
+    constexpr bool string_is_noexcept = noexcept(relocate(std::declval<std::string*>(), std::declval<std::string*>()));
+    constexpr bool unique_ptr_is_noexcept =
+        noexcept(uninitialized_relocate(std::declval<std::unique_ptr<int>*>(), std::declval<std::unique_ptr<int>*>(),
+                                        std::declval<std::unique_ptr<int>*>()));
+    BOOST_TEST(string_is_noexcept);
+    BOOST_TEST(unique_ptr_is_noexcept);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+/*
+strong_assert.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/strong_assert.hpp>
+
+#define BOOST_TEST_MODULE strong_assert test
+#include <boost/test/included/unit_test.hpp>
+
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#define MILLI_TEST_FORK
+#endif
+
+using namespace milli;
+
+namespace {
+#ifdef MILLI_TEST_FORK
+  struct child_result {
+    int status;
+    std::string error_output;
+  };
+
+  // Runs function in a child process and collects what it wrote to stderr.
+  template<typename Function>
+  auto run_in_child(Function function) -> child_result {
+    int pipe_ends[2];
+    BOOST_REQUIRE(pipe(pipe_ends) == 0);
+
+    pid_t child = fork();
+    BOOST_REQUIRE(child >= 0);
+    if(child == 0){
+      std::signal(SIGABRT, SIG_DFL);
+      dup2(pipe_ends[1], 2);
+      close(pipe_ends[0]);
+      function();
+      _exit(0);
+    }
+
+    close(pipe_ends[1]);
+    child_result result{0, ""};
+    char buffer[256];
+    ssize_t size;
+    while((size = read(pipe_ends[0], buffer, sizeof(buffer))) > 0)
+      result.error_output.append(buffer, static_cast<std::size_t>(size));
+    close(pipe_ends[0]);
+    waitpid(child, &result.status, 0);
+    return result;
+  }
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE(strong_assert_test_suite)
+
+  BOOST_AUTO_TEST_CASE(true_condition_continues) {
+    strong_assert(true, "never printed");
+    BOOST_TEST(true);
+  }
+
+#ifdef MILLI_TEST_FORK
+
+  BOOST_AUTO_TEST_CASE(false_condition_terminates_with_message) {
+    auto result = run_in_child([]{ strong_assert(false, "value was empty", "location"); });
+
+    BOOST_TEST(WIFSIGNALED(result.status));
+    BOOST_TEST(WTERMSIG(result.status) == SIGABRT);
+    BOOST_TEST(result.error_output.find("location :=> value was empty\n") == 0u);
+  }
+
+  BOOST_AUTO_TEST_CASE(message_without_location) {
+    auto result = run_in_child([]{ strong_assert(false, "only message"); });
+    BOOST_TEST(result.error_output.find("only message\n") == 0u);
+  }
+
+  BOOST_AUTO_TEST_CASE(long_message_is_truncated) {
+    static const std::string message(4000, 'x');
+    auto result = run_in_child([]{ strong_assert(false, message.c_str()); });
+
+    BOOST_TEST(WIFSIGNALED(result.status));
+    BOOST_TEST(result.error_output.find(std::string(1023, 'x') + "\n") == 0u);
+  }
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+/*
+tagged_not_empty.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <milli/tagged_not_empty.hpp>
+
+#define BOOST_TEST_MODULE tagged_not_empty test
+#include <boost/test/included/unit_test.hpp>
+
+using namespace milli;
+
+namespace {
+  enum class color : unsigned char { red, black };
+
+  struct alignas(8) node {
+    int value;
+    tagged_not_empty_h<node*, 1, color>* next;
+  };
+
+  // Declared while list_node is incomplete, like the links of lock-free lists are.
+  struct list_node {
+    long value;
+    tagged_not_empty_i<list_node*, 2> next;
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(tagged_not_empty_test_suite)
+
+  BOOST_AUTO_TEST_CASE(one_word) {
+    BOOST_TEST(sizeof(tagged_not_empty_e<node*, 3>) == sizeof(node*));
+  }
+
+  BOOST_AUTO_TEST_CASE(no_default_or_null_constructor) {
+    constexpr bool is_default_constructible = std::is_default_constructible<tagged_not_empty_e<node*, 3>>::value;
+    constexpr bool is_nullptr_constructible = std::is_constructible<tagged_not_empty_e<node*, 3>, std::nullptr_t>::value;
+
+    BOOST_TEST(is_default_constructible == false);
+    BOOST_TEST(is_nullptr_constructible == false);
+  }
+
+  BOOST_AUTO_TEST_CASE(null_pointer_initialization_fails) {
+    node* empty = nullptr;
+    BOOST_CHECK_THROW((tagged_not_empty_e<node*, 3>(empty)), milli::value_not_empty);
+    BOOST_CHECK_THROW((tagged_not_empty_e<node*, 3>::from_bits(5)), milli::value_not_empty);
+  }
+
+  BOOST_AUTO_TEST_CASE(low_bits_round_trip) {
+    node value{7, nullptr};
+    for(std::uintptr_t tag = 0; tag != 8; ++tag){
+      tagged_not_empty_e<node*, 3> test(&value, tag);
+
+      BOOST_TEST(test.get() == &value);
+      BOOST_TEST(test.tag() == tag);
+      BOOST_TEST(test->value == 7);
+      BOOST_TEST((*test).value == 7);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(enum_tag) {
+    node value{1, nullptr};
+    tagged_not_empty_h<node*, 1, color> test(&value, color::black);
+
+    BOOST_TEST((test.tag() == color::black));
+    test.set_tag(color::red);
+    BOOST_TEST((test.tag() == color::red));
+    BOOST_TEST(test.get() == &value);
+  }
+
+  BOOST_AUTO_TEST_CASE(reset_keeps_checking) {
+    node first{1, nullptr};
+    node second{2, nullptr};
+    tagged_not_empty_e<node*, 2> test(&first, 3);
+
+    test.reset(&second, 1);
+    BOOST_TEST(test->value == 2);
+    BOOST_TEST(test.tag() == 1u);
+
+    node* empty = nullptr;
+    BOOST_CHECK_THROW(test.reset(empty), milli::value_not_empty);
+    BOOST_TEST(test->value == 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(bits_round_trip) {
+    node value{3, nullptr};
+    tagged_not_empty_e<node*, 2> test(&value, 2);
+    auto restored = tagged_not_empty_e<node*, 2>::from_bits(test.bits());
+
+    BOOST_TEST((restored == test));
+    BOOST_TEST(restored.tag() == 2u);
+    restored.set_tag(1);
+    BOOST_TEST((restored != test));
+  }
+
+  BOOST_AUTO_TEST_CASE(incomplete_element_type) {
+    list_node last{2, tagged_not_empty_i<list_node*, 2>(&last)};
+    list_node first{1, tagged_not_empty_i<list_node*, 2>(&last, 1)};
+
+    BOOST_TEST(first.next->value == 2);
+    BOOST_TEST(first.next.tag() == 1u);
+  }
+
+#if MILLI_TAGGED_POINTER_HIGH_BITS >= 13
+
+  BOOST_AUTO_TEST_CASE(high_bits_round_trip) {
+    node value{5, nullptr};
+    const std::uintptr_t tags[] = {0, 1, 7, 8, 0x155, 0xFFF, 0x1000, 0x1FFF};
+    for(auto tag : tags){
+      tagged_not_empty_e<node*, 16> test(&value, tag);
+
+      BOOST_TEST(test.get() == &value);
+      BOOST_TEST(test.tag() == tag);
+    }
+  }
+
+#endif
+
+  BOOST_AUTO_TEST_CASE(noexceptness) {
+    constexpr bool hard_noexcept = std::is_nothrow_constructible<tagged_not_empty_h<node*, 1>, node*>::value;
+    constexpr bool exception_noexcept = std::is_nothrow_constructible<tagged_not_empty_e<node*, 1>, node*>::value;
+
+    BOOST_TEST(hard_noexcept);
+    BOOST_TEST(not exception_noexcept);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
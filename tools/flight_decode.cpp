@@ -0,0 +1,45 @@
+/*
+flight_decode.cpp: This file is part of the Milli Library.
+
+    Copyright (C) Dawid Pilarski, PanicSoftware 2019-2019
+    Distributed under the BSD 3-clause License.
+    (See Milli/LICENSE)
+
+    Milli IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+    SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+    FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+    ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+// Prints a dump written by milli::flight_recorder::dump_to_file() as text:
+//   milli_flight_decode flight.bin
+
+#include <milli/flight_recorder.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::fprintf(stderr, "usage: %s <flight recorder dump>\n", argv[0]);
+    return 2;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  if (not file) {
+    std::fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+    return 1;
+  }
+
+  std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::fflush(stdout);
+  if (not milli::flight_recorder::decode(data.data(), data.size(), 1)) {
+    std::fprintf(stderr, "%s: %s is not a milli flight recorder dump\n", argv[0], argv[1]);
+    return 1;
+  }
+  return 0;
+}